@@ -126,6 +126,11 @@ public:
       return resultAsValue;
     }
 
+    /// Generic Value interface version of retractInPlace, does not allocate
+    void retractInPlace_(const Vector& delta) override {
+      value_ = traits<T>::Retract(value_, delta);
+    }
+
     /// Generic Value interface version of localCoordinates
     Vector localCoordinates_(const Value& value2) const override {
       // Cast the base class Value pointer to a templated generic class pointer
@@ -261,6 +261,13 @@ namespace gtsam {
       full().triangularView<Eigen::Upper>().setZero();
     }
 
+    /// Add the active matrix of `other`, which must have the same block
+    /// structure. Only reads and updates the upper triangular part.
+    void updateFullMatrix(const SymmetricBlockMatrix& other) {
+      assert(other.rows() == rows());
+      full().triangularView<Eigen::Upper>() += other.full();
+    }
+
     /// Negate the entire active matrix.
     void negate();
 
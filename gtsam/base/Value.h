@@ -69,6 +69,17 @@ namespace gtsam {
      */
     virtual Value* retract_(const Vector& delta) const = 0;
 
+    /** Increment the value in place, i.e., replace it with retract_(delta).
+     * The default implementation goes through retract_, derived classes can
+     * override it to avoid allocating a temporary Value.
+     * @param delta The delta vector in the tangent space of this value.
+     */
+    virtual void retractInPlace_(const Vector& delta) {
+      Value* retracted = retract_(delta);
+      *this = *retracted;
+      retracted->deallocate_();
+    }
+
     /** Compute the coordinates in the tangent space of this value that
      * retract() would map to \c value.
      * @param value The value whose coordinates should be determined in the
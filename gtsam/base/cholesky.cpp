@@ -22,6 +22,11 @@
 
 #include <cmath>
 
+#ifdef GTSAM_USE_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
+
 using namespace std;
 
 namespace gtsam {
@@ -31,6 +36,83 @@ static const double zeroPivotThreshold = 1e-6;
 static const double underconstrainedPrior = 1e-5;
 static const int underconstrainedExponentDifference = 12;
 
+#ifdef GTSAM_USE_TBB
+// Cliques with at least this many frontal or separator columns are factored
+// in parallel, in groups of parallelBlockColumns columns. A large frontal
+// block, as in the root clique of a large problem, is factored by a blocked
+// right-looking Cholesky with a parallel trailing update. A large separator
+// is solved and updated in parallel.
+static const size_t parallelMinColumns = 256;
+static const size_t parallelBlockColumns = 64;
+
+/* ************************************************************************* */
+// Given the factored upper triangle R of a panel, compute P <- inv(R') * P and
+// the trailing update T <- T - P' * P, in parallel over groups of columns of P
+// and T. Only the upper triangle of T is updated.
+template <class TRIANGLE, class PANEL, class TRAILING>
+static void parallelPanelUpdate(const TRIANGLE& R, PANEL P, TRAILING T) {
+  const size_t m = P.cols();
+  const size_t nBlocks = (m + parallelBlockColumns - 1) / parallelBlockColumns;
+  const auto columns = [&](size_t block) {
+    const size_t j0 = block * parallelBlockColumns;
+    return std::make_pair(j0, std::min(parallelBlockColumns, m - j0));
+  };
+
+  // Columns of P, and of the upper triangle of T, are independent
+  gttic(compute_S);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, nBlocks),
+                    [&](const tbb::blocked_range<size_t>& range) {
+                      for (size_t b = range.begin(); b != range.end(); ++b) {
+                        const auto [j0, w] = columns(b);
+                        auto Pj = P.middleCols(j0, w);
+                        R.transpose().solveInPlace(Pj);
+                      }
+                    });
+  gttoc(compute_S);
+
+  gttic(compute_L);
+  tbb::parallel_for(
+      tbb::blocked_range<size_t>(0, nBlocks),
+      [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t b = range.begin(); b != range.end(); ++b) {
+          const auto [j0, w] = columns(b);
+          const auto Pj = P.middleCols(j0, w);
+          T.block(0, j0, j0, w).noalias() -= P.leftCols(j0).transpose() * Pj;
+          T.block(j0, j0, w, w)
+              .template selfadjointView<Eigen::Upper>()
+              .rankUpdate(Pj.transpose(), -1.0);
+        }
+      });
+  gttoc(compute_L);
+}
+
+/* ************************************************************************* */
+// Blocked right-looking partial Cholesky of the n*n block M: factor panels of
+// parallelBlockColumns frontal columns, each followed by a parallel update of
+// everything to its right and below, including the separator.
+template <class BLOCK>
+static bool choleskyPartialBlocked(BLOCK M, size_t nFrontal) {
+  const size_t n = M.rows();
+  for (size_t k0 = 0; k0 < nFrontal; k0 += parallelBlockColumns) {
+    const size_t w = std::min(parallelBlockColumns, nFrontal - k0);
+    auto Akk = M.block(k0, k0, w, w);
+    gttic(LLT);
+    Eigen::LLT<Matrix, Eigen::Upper> llt(Akk);
+    if (llt.info() != Eigen::Success)
+      return false;
+    Akk.template triangularView<Eigen::Upper>() = llt.matrixU();
+    gttoc(LLT);
+
+    const size_t r0 = k0 + w;
+    if (r0 < n)
+      parallelPanelUpdate(Akk.template triangularView<Eigen::Upper>(),
+                          M.block(k0, r0, w, n - r0),
+                          M.block(r0, r0, n - r0, n - r0));
+  }
+  return true;
+}
+#endif
+
 /* ************************************************************************* */
 static inline int choleskyStep(Matrix& ATA, size_t k, size_t order) {
   // Get pivot value
@@ -118,28 +200,44 @@ bool choleskyPartial(Matrix& ABC, size_t nFrontal, size_t topleft) {
   auto A = ABC.block(topleft, topleft, nFrontal, nFrontal);
   auto B = ABC.block(topleft, topleft + nFrontal, nFrontal, n - nFrontal);
   auto C = ABC.block(topleft + nFrontal, topleft + nFrontal, n - nFrontal, n - nFrontal);
-
-  // Compute Cholesky factorization A = R'*R, overwrites A.
-  gttic(LLT);
-  Eigen::LLT<Matrix, Eigen::Upper> llt(A);
-  Eigen::ComputationInfo lltResult = llt.info();
-  if (lltResult != Eigen::Success)
-    return false;
   auto R = A.triangularView<Eigen::Upper>();
-  R = llt.matrixU();
-  gttoc(LLT);
 
-  // Compute S = inv(R') * B
-  gttic(compute_S);
-  if (nFrontal < n)
-    R.transpose().solveInPlace(B);
-  gttoc(compute_S);
+#ifdef GTSAM_USE_TBB
+  if (nFrontal >= parallelMinColumns) {
+    // Blocked factorization, which also computes S and L
+    if (!choleskyPartialBlocked(ABC.block(topleft, topleft, n, n), nFrontal))
+      return false;
+  } else
+#endif
+  {
+    // Compute Cholesky factorization A = R'*R, overwrites A.
+    gttic(LLT);
+    Eigen::LLT<Matrix, Eigen::Upper> llt(A);
+    Eigen::ComputationInfo lltResult = llt.info();
+    if (lltResult != Eigen::Success)
+      return false;
+    R = llt.matrixU();
+    gttoc(LLT);
 
-  // Compute L = C - S' * S
-  gttic(compute_L);
-  if (nFrontal < n)
-    C.selfadjointView<Eigen::Upper>().rankUpdate(B.transpose(), -1.0);
-  gttoc(compute_L);
+#ifdef GTSAM_USE_TBB
+    if (n - nFrontal >= parallelMinColumns) {
+      parallelPanelUpdate(R, B, C);
+    } else
+#endif
+    {
+      // Compute S = inv(R') * B
+      gttic(compute_S);
+      if (nFrontal < n)
+        R.transpose().solveInPlace(B);
+      gttoc(compute_S);
+
+      // Compute L = C - S' * S
+      gttic(compute_L);
+      if (nFrontal < n)
+        C.selfadjointView<Eigen::Upper>().rankUpdate(B.transpose(), -1.0);
+      gttoc(compute_L);
+    }
+  }
 
   // Check last diagonal element - Eigen does not check it
   if (nFrontal >= 2) {
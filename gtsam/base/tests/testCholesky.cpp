@@ -66,6 +66,55 @@ TEST(cholesky, choleskyPartial) {
   EXPECT(assert_equal(expected, actual, 1e-9));
 }
 
+/* ************************************************************************* */
+TEST(cholesky, choleskyPartialLarge) {
+  // Large enough separator to take the parallel path when TBB is enabled
+  const int n = 330, nFrontal = 30;
+  const Matrix M = Matrix::Random(n, n);
+  Matrix ABC = M.transpose() * M + n * Matrix::Identity(n, n);
+  ABC.triangularView<Eigen::StrictlyLower>().setZero();
+
+  Matrix RSL(ABC);
+  EXPECT(choleskyPartial(RSL, nFrontal));
+
+  Matrix R1 = RSL.transpose();
+  Matrix R2 = RSL;
+  R1.block(nFrontal, nFrontal, n - nFrontal, n - nFrontal).setIdentity();
+  R2.block(nFrontal, nFrontal, n - nFrontal, n - nFrontal) =
+      R2.block(nFrontal, nFrontal, n - nFrontal, n - nFrontal)
+          .selfadjointView<Eigen::Upper>();
+
+  Matrix expected = ABC.selfadjointView<Eigen::Upper>();
+  EXPECT(assert_equal(expected, R1 * R2, 1e-9));
+}
+
+/* ************************************************************************* */
+TEST(cholesky, choleskyPartialLargeFrontal) {
+  // Large enough frontal block to take the blocked parallel path when TBB is
+  // enabled, both for a root clique without separator and with one
+  for (const int nSeparator : {0, 70}) {
+    const int nFrontal = 300, n = nFrontal + nSeparator;
+    const Matrix M = Matrix::Random(n, n);
+    Matrix ABC = M.transpose() * M + n * Matrix::Identity(n, n);
+    ABC.triangularView<Eigen::StrictlyLower>().setZero();
+
+    Matrix RSL(ABC);
+    EXPECT(choleskyPartial(RSL, nFrontal));
+
+    Matrix R1 = RSL.transpose();
+    Matrix R2 = RSL;
+    R1.triangularView<Eigen::StrictlyUpper>().setZero();
+    R2.triangularView<Eigen::StrictlyLower>().setZero();
+    R1.block(nFrontal, nFrontal, nSeparator, nSeparator).setIdentity();
+    R2.block(nFrontal, nFrontal, nSeparator, nSeparator) =
+        R2.block(nFrontal, nFrontal, nSeparator, nSeparator)
+            .selfadjointView<Eigen::Upper>();
+
+    Matrix expected = ABC.selfadjointView<Eigen::Upper>();
+    EXPECT(assert_equal(expected, R1 * R2, 1e-9));
+  }
+}
+
 /* ************************************************************************* */
 TEST(cholesky, BadScalingCholesky) {
   Matrix A = (Matrix(2,2) <<
@@ -22,6 +22,7 @@
 #include <vector>
 #include <list>
 #include <memory>
+#include <mutex>
 
 using namespace gtsam;
 
@@ -31,6 +32,7 @@ struct TestNode {
   std::vector<shared_ptr> children;
   TestNode() : data(-1) {}
   TestNode(int data) : data(data) {}
+  int problemSize() const { return 100; }  // always split in parallel traversals
 };
 
 struct TestForest {
@@ -120,6 +122,61 @@ TEST(treeTraversal, DepthFirst)
   EXPECT(assert_container_equality(postOrderExpected, postVisitor.visited));
 }
 
+/* ************************************************************************* */
+TEST(treeTraversal, DepthFirstParallelByCost)
+{
+  TestForest testForest = makeTestForest();
+
+  // Visit in parallel, with costs such that node 3 gets its own task and the
+  // other subtrees are grouped together.
+  std::mutex mutex;
+  std::vector<int> parents(5, -2);
+  std::vector<bool> childrenDone(5, false);
+  bool postOrderValid = true;
+  auto visitorPre = [&](const TestNode::shared_ptr& node, int parentData) {
+    std::lock_guard<std::mutex> lock(mutex);
+    parents[node->data] = parentData;
+    return node->data;
+  };
+  auto visitorPost = [&](const TestNode::shared_ptr& node, int myData) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& child : node->children)
+      if (!childrenDone[child->data]) postOrderValid = false;
+    childrenDone[myData] = true;
+  };
+  auto subtreeCost = [](const TestNode::shared_ptr& node) {
+    return node->data == 3 || node->data == 0 ? 10.0 : 1.0;
+  };
+  int rootData = -1;
+  treeTraversal::DepthFirstForestParallel(testForest, rootData, visitorPre,
+                                          visitorPost, subtreeCost, 5.0);
+
+  EXPECT(postOrderValid);
+  EXPECT(std::vector<int>({-1, -1, 0, 0, 3}) == parents);
+  EXPECT(std::vector<bool>(5, true) == childrenDone);
+}
+
+/* ************************************************************************* */
+TEST(treeTraversal, ForestParallelTopDown)
+{
+  TestForest testForest = makeTestForest();
+
+  // Every node is visited once, after its parent
+  std::mutex mutex;
+  std::vector<int> visits(5, 0);
+  bool parentsFirst = true;
+  auto visitor = [&](const TestNode::shared_ptr& node) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++visits[node->data];
+    for (const auto& child : node->children)
+      if (visits[child->data] != 0) parentsFirst = false;
+  };
+  treeTraversal::ForestParallelTopDown(testForest, visitor);
+
+  EXPECT(parentsFirst);
+  EXPECT(std::vector<int>(5, 1) == visits);
+}
+
 /* ************************************************************************* */
 TEST(treeTraversal, CloneForest)
 {
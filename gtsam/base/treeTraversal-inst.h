@@ -167,6 +167,63 @@ void DepthFirstForestParallel(FOREST& forest, DATA& rootData,
 #endif
 }
 
+/** Traverse a forest depth-first with pre-order and post-order visits, in parallel, scheduling
+ *  tasks by an estimate of the cost of each subtree rather than by problem size.  Subtrees
+ *  cheaper than \c costThreshold are visited serially within a single task, and cheap sibling
+ *  subtrees are grouped into tasks of at least \c costThreshold, so the number of tasks tracks
+ *  the amount of work instead of the number of nodes.
+ *  @param forest The forest of trees to traverse, see DepthFirstForest.
+ *  @param rootData The data to pass to \c visitorPre for each root node.
+ *  @param visitorPre The pre-order visitor, see DepthFirstForest.
+ *  @param visitorPost The post-order visitor, see DepthFirstForest.
+ *  @param subtreeCost \c subtreeCost(node) returns the estimated cost of visiting all nodes in
+ *         the subtree rooted at \c node.
+ *  @param costThreshold Subtrees below this cost are not split into further tasks.
+ */
+template<class FOREST, typename DATA, typename VISITOR_PRE,
+    typename VISITOR_POST, typename COST>
+void DepthFirstForestParallel(FOREST& forest, DATA& rootData,
+    VISITOR_PRE& visitorPre, VISITOR_POST& visitorPost,
+    const COST& subtreeCost, double costThreshold) {
+#ifdef GTSAM_USE_TBB
+  // Typedefs
+  typedef typename FOREST::Node Node;
+
+  internal::CreateRootTaskByCost<Node>(forest.roots(), rootData, visitorPre,
+      visitorPost, subtreeCost, costThreshold);
+#else
+  DepthFirstForest(forest, rootData, visitorPre, visitorPost);
+#endif
+}
+
+/** Visit all nodes of a forest top-down, in parallel.  \c visitor(node) is called on every node
+ *  after it returns on the node's parent, and may be called on siblings concurrently.  This is
+ *  all that is needed for top-down passes such as back-substitution, and unlike the pre-order
+ *  visitor of DepthFirstForestParallel, the visit of each node runs in its own task.
+ *  @param forest The forest of trees to traverse, see DepthFirstForest.
+ *  @param visitor \c visitor(node) is called at every node.
+ *  @param problemSizeThreshold The children of nodes with a smaller problem size are visited
+ *         serially within the task of their parent.
+ */
+template<class FOREST, typename VISITOR>
+void ForestParallelTopDown(FOREST& forest, VISITOR& visitor,
+    int problemSizeThreshold = 10) {
+#ifdef GTSAM_USE_TBB
+  typedef typename FOREST::Node Node;
+  internal::CreateTopDownTasks<Node>(forest.roots(), visitor, problemSizeThreshold);
+#else
+  // Visit nodes in depth-first pre-order
+  std::vector<std::shared_ptr<typename FOREST::Node> > stack(
+      forest.roots().rbegin(), forest.roots().rend());
+  while (!stack.empty()) {
+    const auto node = stack.back();
+    stack.pop_back();
+    (void) visitor(node);
+    stack.insert(stack.end(), node->children.rbegin(), node->children.rend());
+  }
+#endif
+}
+
 /* ************************************************************************* */
 /** Traversal function for CloneForest */
 namespace {
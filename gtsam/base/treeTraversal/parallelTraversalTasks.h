@@ -19,6 +19,8 @@
 #include <gtsam/global_includes.h>
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #ifdef GTSAM_USE_TBB
 #include <tbb/task_group.h>         // tbb::task_group
@@ -155,6 +157,204 @@ namespace gtsam {
           tg.run_and_wait(RootTask(roots, rootData, visitorPre, visitorPost, problemSizeThreshold, tg));
       }
 
+      /* ************************************************************************* */
+      // Visit a subtree serially, in the calling task
+      template<typename NODE, typename DATA, typename VISITOR_PRE, typename VISITOR_POST>
+      void ProcessNodeRecursively(const std::shared_ptr<NODE>& node, DATA& myData,
+                                  VISITOR_PRE& visitorPre, VISITOR_POST& visitorPost)
+      {
+        for(const std::shared_ptr<NODE>& child: node->children)
+        {
+          DATA childData = visitorPre(child, myData);
+          ProcessNodeRecursively(child, childData, visitorPre, visitorPost);
+        }
+        (void) visitorPost(node, myData);
+      }
+
+      /* ************************************************************************* */
+      // A group of cheap sibling subtrees, visited serially in a single task
+      template<typename NODE, typename DATA, typename VISITOR_PRE, typename VISITOR_POST>
+      class ChunkTask
+      {
+      public:
+        typedef std::vector<std::pair<std::shared_ptr<NODE>, std::shared_ptr<DATA> > > Subtrees;
+        Subtrees subtrees;
+        VISITOR_PRE& visitorPre;
+        VISITOR_POST& visitorPost;
+
+        ChunkTask(Subtrees&& subtrees, VISITOR_PRE& visitorPre, VISITOR_POST& visitorPost)
+            : subtrees(std::move(subtrees)), visitorPre(visitorPre), visitorPost(visitorPost) {}
+
+        void operator()() const
+        {
+          for(const auto& subtree: subtrees)
+            ProcessNodeRecursively(subtree.first, *subtree.second, visitorPre, visitorPost);
+        }
+      };
+
+      /* ************************************************************************* */
+      // Spawn tasks for the given subtrees: a task for each subtree at or above the cost
+      // threshold, and tasks for groups of cheaper subtrees adding up to the threshold.
+      template<typename NODE, typename TASK, typename CHILDREN, typename DATA,
+               typename VISITOR_PRE, typename VISITOR_POST, typename COST>
+      void SpawnByCost(const CHILDREN& children, DATA& parentData, VISITOR_PRE& visitorPre,
+                       VISITOR_POST& visitorPost, const COST& subtreeCost, double costThreshold,
+                       tbb::task_group& tg)
+      {
+        typedef ChunkTask<NODE, DATA, VISITOR_PRE, VISITOR_POST> Chunk;
+        typename Chunk::Subtrees chunk;
+        double chunkCost = 0.0;
+        for(const std::shared_ptr<NODE>& child: children)
+        {
+          // Run visitorPre before creating the task, see PreOrderTask
+          std::shared_ptr<DATA> childData = std::allocate_shared<DATA>(
+              tbb::scalable_allocator<DATA>(), visitorPre(child, parentData));
+          const double cost = subtreeCost(child);
+          if(cost >= costThreshold)
+          {
+            tg.run(TASK(child, childData, visitorPre, visitorPost, subtreeCost, costThreshold, tg));
+          }
+          else
+          {
+            chunk.emplace_back(child, childData);
+            chunkCost += cost;
+            if(chunkCost >= costThreshold)
+            {
+              tg.run(Chunk(std::move(chunk), visitorPre, visitorPost));
+              chunk.clear();
+              chunkCost = 0.0;
+            }
+          }
+        }
+        if(!chunk.empty())
+          tg.run(Chunk(std::move(chunk), visitorPre, visitorPost));
+      }
+
+      /* ************************************************************************* */
+      // Like PreOrderTask, but decides which subtrees get their own task from their cost
+      template<typename NODE, typename DATA, typename VISITOR_PRE, typename VISITOR_POST, typename COST>
+      class CostPreOrderTask
+      {
+      public:
+        const std::shared_ptr<NODE>& treeNode;
+        std::shared_ptr<DATA> myData;
+        VISITOR_PRE& visitorPre;
+        VISITOR_POST& visitorPost;
+        const COST& subtreeCost;
+        double costThreshold;
+        tbb::task_group& tg;
+
+        // Keep track of order phase across multiple calls to the same functor
+        mutable bool isPostOrderPhase;
+
+        CostPreOrderTask(const std::shared_ptr<NODE>& treeNode, const std::shared_ptr<DATA>& myData,
+                         VISITOR_PRE& visitorPre, VISITOR_POST& visitorPost, const COST& subtreeCost,
+                         double costThreshold, tbb::task_group& tg)
+            : treeNode(treeNode),
+              myData(myData),
+              visitorPre(visitorPre),
+              visitorPost(visitorPost),
+              subtreeCost(subtreeCost),
+              costThreshold(costThreshold),
+              tg(tg),
+              isPostOrderPhase(false) {}
+
+        void operator()() const
+        {
+          if(isPostOrderPhase)
+          {
+            // Run the post-order visitor since this task was recycled to run the post-order visitor
+            (void) visitorPost(treeNode, *myData);
+          }
+          else if(treeNode->children.empty())
+          {
+            (void) visitorPost(treeNode, *myData);
+          }
+          else
+          {
+            // Start subtasks for the children and wait for them to complete
+            tbb::task_group ctg;
+            SpawnByCost<NODE, CostPreOrderTask>(treeNode->children, *myData, visitorPre,
+                visitorPost, subtreeCost, costThreshold, ctg);
+            ctg.wait();
+
+            // Allocate post-order task as a continuation
+            isPostOrderPhase = true;
+            tg.run(*this);
+          }
+        }
+      };
+
+      /* ************************************************************************* */
+      // Visit a node, then its children, each in its own task if the node is large enough
+      template<typename NODE, typename VISITOR>
+      class TopDownTask
+      {
+      public:
+        const std::shared_ptr<NODE>& treeNode;
+        VISITOR& visitor;
+        int problemSizeThreshold;
+        bool makeNewTasks;
+
+        TopDownTask(const std::shared_ptr<NODE>& treeNode, VISITOR& visitor,
+                    int problemSizeThreshold, bool makeNewTasks = true)
+            : treeNode(treeNode),
+              visitor(visitor),
+              problemSizeThreshold(problemSizeThreshold),
+              makeNewTasks(makeNewTasks) {}
+
+        void operator()() const
+        {
+          if(makeNewTasks)
+          {
+            (void) visitor(treeNode);
+            if(!treeNode->children.empty())
+            {
+              bool overThreshold = (treeNode->problemSize() >= problemSizeThreshold);
+              tbb::task_group ctg;
+              for(const std::shared_ptr<NODE>& child: treeNode->children)
+                ctg.run(TopDownTask(child, visitor, problemSizeThreshold, overThreshold));
+              ctg.wait();
+            }
+          }
+          else
+          {
+            processNodeRecursively(treeNode);
+          }
+        }
+
+        void processNodeRecursively(const std::shared_ptr<NODE>& node) const
+        {
+          (void) visitor(node);
+          for(const std::shared_ptr<NODE>& child: node->children)
+            processNodeRecursively(child);
+        }
+      };
+
+      template<typename NODE, typename ROOTS, typename VISITOR>
+      void CreateTopDownTasks(const ROOTS& roots, VISITOR& visitor, int problemSizeThreshold)
+      {
+        typedef TopDownTask<NODE, VISITOR> Task;
+        tbb::task_group tg;
+        for(const std::shared_ptr<NODE>& root: roots)
+          tg.run(Task(root, visitor, problemSizeThreshold));
+        tg.wait();
+      }
+
+      template<typename NODE, typename ROOTS, typename DATA, typename VISITOR_PRE,
+               typename VISITOR_POST, typename COST>
+      void CreateRootTaskByCost(const ROOTS& roots, DATA& rootData, VISITOR_PRE& visitorPre,
+                                VISITOR_POST& visitorPost, const COST& subtreeCost,
+                                double costThreshold)
+      {
+        typedef CostPreOrderTask<NODE, DATA, VISITOR_PRE, VISITOR_POST, COST> Task;
+        tbb::task_group tg;
+        tg.run_and_wait([&]() {
+          SpawnByCost<NODE, Task>(roots, rootData, visitorPre, visitorPost, subtreeCost,
+                                  costThreshold, tg);
+        });
+      }
+
     }
 
   }
@@ -40,6 +40,15 @@ std::vector<size_t> ClusterTree<GRAPH>::Cluster::nrFrontalsOfChildren() const {
   return nrFrontals;
 }
 
+/* ************************************************************************* */
+template <class GRAPH>
+void ClusterTree<GRAPH>::Cluster::estimateCost(double frontalDim,
+                                               double separatorDim) {
+  cost_ = EliminationCost(frontalDim, separatorDim);
+  subtreeCost_ = cost_;
+  for (const sharedNode& child : children) subtreeCost_ += child->subtreeCost_;
+}
+
 /* ************************************************************************* */
 template <class GRAPH>
 void ClusterTree<GRAPH>::Cluster::merge(const std::shared_ptr<Cluster>& cluster) {
@@ -295,8 +304,17 @@ EliminatableClusterTree<BAYESTREE, GRAPH>::eliminate(const Eliminate& function)
   typename Data::EliminationPostOrderVisitor visitorPost(function, result->nodes_);
   {
     TbbOpenMPMixedScope threadLimiter;  // Limits OpenMP threads since we're mixing TBB and OpenMP
-    treeTraversal::DepthFirstForestParallel(*this, rootsContainer, Data::EliminationPreOrderVisitor,
-                                            visitorPost, 10);
+    if constexpr (internal::HasVariableDims<FactorType>::value) {
+      // Costs are in flops: subtrees below the threshold are eliminated serially in a single task
+      auto subtreeCost = [](const auto& node) { return node->subtreeCost(); };
+      treeTraversal::DepthFirstForestParallel(*this, rootsContainer,
+                                              Data::EliminationPreOrderVisitor, visitorPost,
+                                              subtreeCost, 1e5);
+    } else {
+      // Without variable dimensions the costs are not in flops, schedule by problem size
+      treeTraversal::DepthFirstForestParallel(*this, rootsContainer,
+                                              Data::EliminationPreOrderVisitor, visitorPost, 10);
+    }
   }
 
   // Create BayesTree from roots stored in the dummy BayesTree node.
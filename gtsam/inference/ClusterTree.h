@@ -13,8 +13,23 @@
 #include <gtsam/base/FastVector.h>
 #include <gtsam/inference/Ordering.h>
 
+#include <type_traits>
+#include <utility>
+
 namespace gtsam {
 
+namespace internal {
+/// True if FACTOR reports the dimension of its variables, as GaussianFactor does
+template <class FACTOR, typename = void>
+struct HasVariableDims : std::false_type {};
+
+template <class FACTOR>
+struct HasVariableDims<
+    FACTOR, std::void_t<decltype(std::declval<const FACTOR&>().getDim(
+                std::declval<typename FACTOR::const_iterator>()))> >
+    : std::true_type {};
+}  // namespace internal
+
 /**
  * A cluster-tree is associated with a factor graph and is defined as in Koller-Friedman:
  * each node k represents a subset \f$ C_k \sub X \f$, and the tree is family preserving, in that
@@ -44,7 +59,10 @@ class ClusterTree {
 
     int problemSize_;
 
-    Cluster() : problemSize_(0) {}
+    double cost_;         ///< Estimated flops to eliminate this cluster
+    double subtreeCost_;  ///< Estimated flops to eliminate the subtree
+
+    Cluster() : problemSize_(0), cost_(0), subtreeCost_(0) {}
 
     virtual ~Cluster() {}
 
@@ -55,7 +73,7 @@ class ClusterTree {
     /// Construct from factors associated with a single key
     template <class CONTAINER>
     Cluster(Key key, const CONTAINER& factorsToAdd)
-        : problemSize_(0) {
+        : problemSize_(0), cost_(0), subtreeCost_(0) {
       addFactors(key, factorsToAdd);
     }
 
@@ -89,6 +107,35 @@ class ClusterTree {
       return problemSize_;
     }
 
+    /// Estimated number of flops to eliminate this cluster alone
+    double cost() const {
+      return cost_;
+    }
+
+    /// Estimated number of flops to eliminate all clusters in this subtree
+    double subtreeCost() const {
+      return subtreeCost_;
+    }
+
+    /**
+     * Estimate the cost of dense elimination of this cluster, with frontal
+     * and separator variables of total dimension \c frontalDim and
+     * \c separatorDim, and add the subtree costs of the children. Call after
+     * the children are final.
+     */
+    void estimateCost(double frontalDim, double separatorDim);
+
+    /**
+     * Estimated number of flops for partial Cholesky of a front with frontal
+     * and separator variables of total dimension \c frontalDim and
+     * \c separatorDim: factor the frontal block, solve for the off-diagonal
+     * block and update the separator block, for f^3/3 + f^2 s + f s^2 flops.
+     */
+    static double EliminationCost(double frontalDim, double separatorDim) {
+      const double f = frontalDim, s = separatorDim;
+      return f * f * f / 3.0 + f * f * s + f * s * s;
+    }
+
     /// print this node
     virtual void print(const std::string& s = "",
                        const KeyFormatter& keyFormatter = DefaultKeyFormatter) const;
@@ -22,6 +22,7 @@
 
 #include <gtsam/inference/JunctionTree.h>
 #include <gtsam/inference/ClusterTree-inst.h>
+#include <gtsam/base/FastMap.h>
 #include <gtsam/symbolic/SymbolicConditional.h>
 #include <gtsam/symbolic/SymbolicFactor-inst.h>
 
@@ -33,6 +34,7 @@ struct ConstructorTraversalData {
   typedef typename JunctionTree<BAYESTREE, GRAPH>::sharedNode sharedNode;
 
   ConstructorTraversalData* const parentData;
+  const FastMap<Key, size_t>* dims;  // Variable dimensions, empty if unknown
   sharedNode junctionTreeNode;
   FastVector<SymbolicConditional::shared_ptr> childSymbolicConditionals;
   FastVector<SymbolicFactor::shared_ptr> childSymbolicFactors;
@@ -42,7 +44,14 @@ struct ConstructorTraversalData {
   };
 
   ConstructorTraversalData(ConstructorTraversalData* _parentData) :
-      parentData(_parentData) {
+      parentData(_parentData), dims(_parentData ? _parentData->dims : nullptr) {
+  }
+
+  // Dimension of a variable, 1 if the factors do not report dimensions
+  double dim(Key key) const {
+    if (!dims) return 1.0;
+    auto it = dims->find(key);
+    return it == dims->end() ? 1.0 : double(it->second);
   }
 
   // Pre-order visitor function
@@ -116,6 +125,14 @@ struct ConstructorTraversalData {
 
     // now really merge
     node->mergeChildren(merge);
+
+    // Estimate the elimination cost from the dimensions of the merged clique
+    double frontalDim = 0.0, separatorDim = 0.0;
+    for (Key key : node->orderedFrontalKeys) frontalDim += myData.dim(key);
+    for (auto parent = myConditional->beginParents();
+         parent != myConditional->endParents(); ++parent)
+      separatorDim += myData.dim(*parent);
+    node->estimateCost(frontalDim, separatorDim);
   }
 };
 
@@ -137,6 +154,25 @@ JunctionTree<BAYESTREE, GRAPH>::JunctionTree(
   typedef typename EliminationTree<ETREE_BAYESNET, ETREE_GRAPH>::Node ETreeNode;
   typedef ConstructorTraversalData<BAYESTREE, GRAPH, ETreeNode> Data;
   Data rootData(0);
+
+  // Collect the variable dimensions so that cluster costs are in flops
+  FastMap<Key, size_t> dims;
+  if constexpr (internal::HasVariableDims<typename ETREE_GRAPH::FactorType>::value) {
+    std::vector<std::shared_ptr<ETreeNode> > stack(eliminationTree.roots().begin(),
+                                                   eliminationTree.roots().end());
+    while (!stack.empty()) {
+      const std::shared_ptr<ETreeNode> etreeNode = stack.back();
+      stack.pop_back();
+      for (const auto& factor : etreeNode->factors) {
+        if (!factor) continue;
+        for (auto key = factor->begin(); key != factor->end(); ++key)
+          dims.emplace(*key, factor->getDim(key));
+      }
+      stack.insert(stack.end(), etreeNode->children.begin(), etreeNode->children.end());
+    }
+    rootData.dims = &dims;
+  }
+
   // Make a dummy node to gather the junction tree roots
   rootData.junctionTreeNode = std::make_shared<typename Base::Node>();
   treeTraversal::DepthFirstForest(eliminationTree, rootData,
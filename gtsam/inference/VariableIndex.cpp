@@ -68,4 +68,20 @@ void VariableIndex::augmentExistingFactor(const FactorIndex factorIndex, const K
   gttoc(VariableIndex_augmentExistingFactor);
 }
 
+/* ************************************************************************* */
+void VariableIndex::renumberFactors(const FactorIndices& newIndices,
+                                    size_t nFactors) {
+  gttic(VariableIndex_renumberFactors);
+  for (auto& key_factors : index_) {
+    for (FactorIndex& index : key_factors.second) {
+      if (index >= newIndices.size() || newIndices[index] >= nFactors)
+        throw std::invalid_argument(
+            "VariableIndex::renumberFactors: factor without a new index");
+      index = newIndices[index];
+    }
+    key_factors.second.shrink_to_fit();
+  }
+  nFactors_ = nFactors;
+}
+
 }
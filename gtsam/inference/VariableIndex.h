@@ -155,6 +155,15 @@ class GTSAM_EXPORT VariableIndex {
   template<typename ITERATOR, class FG>
   void remove(ITERATOR firstFactor, ITERATOR lastFactor, const FG& factors);
 
+  /**
+   * Renumber the factors, e.g. after the empty slots of a factor graph were
+   * removed. Every factor in the index must have a new index below
+   * \c nFactors, which becomes the number of factors.
+   * @param newIndices The new index of each factor, by its current index
+   * @param nFactors The number of factors after renumbering
+   */
+  void renumberFactors(const FactorIndices& newIndices, size_t nFactors);
+
   /// Remove unused empty variables (in debug mode verifies they are empty).
   template<typename ITERATOR>
   void removeUnusedVariables(ITERATOR firstKey, ITERATOR lastKey);
@@ -0,0 +1,312 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    BayesTreeCovariances.h
+ * @brief   All marginal covariances of a Gaussian Bayes tree in one pass
+ */
+
+#pragma once
+
+#include <gtsam/base/FastMap.h>
+#include <gtsam/base/timing.h>
+#include <gtsam/base/treeTraversal-inst.h>
+#include <gtsam/linear/GaussianConditional.h>
+#include <gtsam/linear/NoiseModel.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gtsam {
+
+/**
+ * Marginal covariances of all variables of a Gaussian Bayes tree, computed in
+ * one top-down pass by the Takahashi recursion.
+ *
+ * Every clique holds a conditional \f$ p(x_F|x_S) \f$ with mean
+ * \f$ R^{-1}(d - S x_S) \f$ and covariance \f$ R^{-1}R^{-T} \f$. Given the
+ * covariance \f$ \Sigma_{SS} \f$ of its separator, which by the running
+ * intersection property is part of the covariance of the parent clique, the
+ * joint covariance of the clique follows as
+ * \f[ \Sigma_{FS} = -R^{-1}S\Sigma_{SS}, \quad
+ *     \Sigma_{FF} = R^{-1}R^{-T} - \Sigma_{FS}(R^{-1}S)^T. \f]
+ * This recovers every block of the covariance in the sparsity pattern of the
+ * Bayes tree: all diagonal blocks, and the off-diagonal blocks of variables
+ * that appear together in a clique, as frontal or separator variables. The
+ * cost is one small dense computation per clique, rather than one marginal per
+ * variable, and siblings are processed in parallel.
+ *
+ * The terms \f$ R^{-1}S \f$ and \f$ R^{-1}R^{-T} \f$ only depend on the
+ * conditional of a clique. update() keeps them for the conditionals that are
+ * unchanged since the previous call, so after an ISAM2 update only the
+ * re-eliminated cliques are inverted again. A conditional counts as unchanged
+ * if it is the same object with the same keys and dimensions, since
+ * ISAM2::marginalizeLeaves trims conditionals in place. The covariances themselves depend
+ * on the whole tree above a clique, so they are always recomputed.
+ *
+ * CLIQUE is the clique type of any Bayes tree of GaussianConditionals, e.g.
+ * GaussianBayesTreeClique or ISAM2Clique.
+ * @ingroup linear
+ */
+template <class CLIQUE>
+class BayesTreeCovariances {
+ public:
+  typedef std::shared_ptr<CLIQUE> sharedClique;
+
+ private:
+  /// Covariance of one clique and the terms it is computed from
+  struct CliqueData {
+    GaussianConditional::shared_ptr conditional;  ///< Also keeps the cache key
+                                                  ///< below alive
+    Matrix gain;                   ///< \f$ R^{-1}S \f$
+    Matrix conditionalCovariance;  ///< \f$ R^{-1}R^{-T} \f$
+    Matrix joint;                  ///< Covariance of frontals and separator
+    KeyVector keys;                   ///< Of the conditional when inverted
+    std::vector<DenseIndex> offsets;  ///< Of each key in joint, and the end
+    size_t parent = 0;                ///< Index of the parent clique
+  };
+
+  std::vector<CliqueData> cliques_;
+
+  /// Clique index and position in the conditional of every variable
+  FastMap<Key, std::pair<size_t, size_t>> locations_;
+
+  size_t cliquesReused_ = 0;
+
+ public:
+  /// Empty, call update() to compute covariances
+  BayesTreeCovariances() = default;
+
+  /// Compute the covariances of all variables in \c bayesTree
+  template <class BAYESTREE>
+  explicit BayesTreeCovariances(const BAYESTREE& bayesTree) {
+    update(bayesTree);
+  }
+
+  /**
+   * Recompute the covariances of all variables in \c bayesTree, reusing the
+   * inverted conditionals of the previous call that are still in the tree.
+   */
+  template <class BAYESTREE>
+  void update(const BAYESTREE& bayesTree);
+
+  /// Whether the covariance of variable \c j is available
+  bool exists(Key j) const { return locations_.count(j) > 0; }
+
+  /// Whether the covariance block of variables \c i and \c j is available
+  bool exists(Key i, Key j) const {
+    size_t clique, a, b;
+    return locate(i, j, &clique, &a, &b);
+  }
+
+  /// The marginal covariance of variable \c j
+  Matrix marginalCovariance(Key j) const { return covariance(j, j); }
+
+  /**
+   * The block of the joint covariance of variables \c i and \c j. Throws
+   * std::invalid_argument if they do not appear together in a clique; use
+   * Marginals::jointMarginalCovariance for such pairs.
+   */
+  Matrix covariance(Key i, Key j) const;
+
+  /// The marginal covariances of all variables
+  FastMap<Key, Matrix> marginalCovariances() const {
+    FastMap<Key, Matrix> result;
+    for (const auto& [key, location] : locations_)
+      result.emplace(key, block(location.first, location.second,
+                                location.second));
+    return result;
+  }
+
+  /// Number of cliques whose inverted conditional was reused by update()
+  size_t cliquesReused() const { return cliquesReused_; }
+
+  /// Number of cliques in the last tree passed to update()
+  size_t cliques() const { return cliques_.size(); }
+
+ private:
+  /// Block of the joint covariance of a clique, between two of its keys
+  Matrix block(size_t clique, size_t a, size_t b) const {
+    const CliqueData& data = cliques_[clique];
+    return data.joint.block(data.offsets[a], data.offsets[b],
+                            data.offsets[a + 1] - data.offsets[a],
+                            data.offsets[b + 1] - data.offsets[b]);
+  }
+
+  /// Position of key \c j among the keys of clique \c clique, or its size
+  size_t position(size_t clique, Key j) const {
+    const KeyVector& keys = cliques_[clique].conditional->keys();
+    return std::find(keys.begin(), keys.end(), j) - keys.begin();
+  }
+
+  /// Find a clique containing \c i and \c j, and their positions in it
+  bool locate(Key i, Key j, size_t* clique, size_t* a, size_t* b) const;
+
+  /// Invert the conditional of a clique, if not done already
+  static void invert(CliqueData* data);
+
+  /// Compute the joint covariance of a clique from that of its parent
+  void computeJoint(size_t clique);
+};
+
+/* ************************************************************************* */
+template <class CLIQUE>
+template <class BAYESTREE>
+void BayesTreeCovariances<CLIQUE>::update(const BAYESTREE& bayesTree) {
+  gttic(BayesTreeCovariances_update);
+  // Inverted conditionals of the previous call, by conditional
+  std::unordered_map<const GaussianConditional*, CliqueData> previous;
+  for (CliqueData& data : cliques_)
+    previous.emplace(data.conditional.get(), std::move(data));
+  cliques_.clear();
+  locations_.clear();
+  cliquesReused_ = 0;
+
+  // Number the cliques parents first, and prepare their data
+  std::unordered_map<const CLIQUE*, size_t> indices;
+  std::vector<std::pair<sharedClique, size_t>> stack;
+  for (const sharedClique& root : bayesTree.roots())
+    stack.emplace_back(root, 0);
+  while (!stack.empty()) {
+    const auto [clique, parent] = stack.back();
+    stack.pop_back();
+    const size_t index = cliques_.size();
+    indices.emplace(clique.get(), index);
+
+    const GaussianConditional::shared_ptr& conditional = clique->conditional();
+    std::vector<DenseIndex> offsets(1, 0);
+    for (auto it = conditional->begin(); it != conditional->end(); ++it)
+      offsets.push_back(offsets.back() + conditional->getDim(it));
+    auto cached = previous.find(conditional.get());
+    if (cached != previous.end() &&
+        cached->second.keys == conditional->keys() &&
+        cached->second.offsets == offsets) {
+      cliques_.push_back(std::move(cached->second));
+      ++cliquesReused_;
+    } else {
+      cliques_.emplace_back();
+      cliques_.back().conditional = conditional;
+      cliques_.back().keys = conditional->keys();
+    }
+    CliqueData& data = cliques_.back();
+    data.parent = parent;
+    data.offsets = std::move(offsets);
+    for (size_t k = 0; k < conditional->nrFrontals(); ++k)
+      locations_.emplace(conditional->keys()[k], std::make_pair(index, k));
+
+    for (const sharedClique& child : clique->children)
+      stack.emplace_back(child, index);
+  }
+
+  // Top-down pass, each clique after its parent
+  auto visitor = [&](const sharedClique& clique) {
+    computeJoint(indices.at(clique.get()));
+  };
+  treeTraversal::ForestParallelTopDown(bayesTree, visitor);
+}
+
+/* ************************************************************************* */
+template <class CLIQUE>
+void BayesTreeCovariances<CLIQUE>::invert(CliqueData* data) {
+  if (data->conditionalCovariance.size() > 0) return;
+  const GaussianConditional& c = *data->conditional;
+  Matrix R = c.R(), S = c.S();
+  if (c.get_model() && !c.get_model()->isUnit()) {
+    c.get_model()->WhitenInPlace(R);
+    c.get_model()->WhitenInPlace(S);
+  }
+  const Matrix Rinv = R.triangularView<Eigen::Upper>().solve(
+      Matrix::Identity(R.rows(), R.cols()));
+  data->gain.noalias() = Rinv * S;
+  data->conditionalCovariance.noalias() = Rinv * Rinv.transpose();
+}
+
+/* ************************************************************************* */
+template <class CLIQUE>
+void BayesTreeCovariances<CLIQUE>::computeJoint(size_t clique) {
+  CliqueData& data = cliques_[clique];
+  invert(&data);
+
+  const GaussianConditional& c = *data.conditional;
+  const size_t nrFrontals = c.nrFrontals();
+  const DenseIndex f = data.offsets[nrFrontals], n = data.offsets.back(),
+                   s = n - f;
+  data.joint.resize(n, n);
+  data.joint.topLeftCorner(f, f) = data.conditionalCovariance;
+  if (s == 0) return;
+
+  // Gather the separator covariance from the joint covariance of the parent
+  const CliqueData& parent = cliques_[data.parent];
+  std::vector<size_t> slots(c.nrParents());
+  for (size_t a = 0; a < slots.size(); ++a) {
+    slots[a] = position(data.parent, c.keys()[nrFrontals + a]);
+    if (slots[a] == parent.conditional->size())
+      throw std::invalid_argument(
+          "BayesTreeCovariances: separator variable not in parent clique");
+  }
+  for (size_t a = 0; a < slots.size(); ++a) {
+    const size_t A = nrFrontals + a;
+    for (size_t b = 0; b < slots.size(); ++b) {
+      const size_t B = nrFrontals + b;
+      data.joint.block(data.offsets[A], data.offsets[B],
+                       data.offsets[A + 1] - data.offsets[A],
+                       data.offsets[B + 1] - data.offsets[B]) =
+          parent.joint.block(parent.offsets[slots[a]],
+                             parent.offsets[slots[b]],
+                             data.offsets[A + 1] - data.offsets[A],
+                             data.offsets[B + 1] - data.offsets[B]);
+    }
+  }
+
+  // Sigma_FS = -R^{-1} S Sigma_SS, Sigma_FF = R^{-1} R^{-T} - Sigma_FS (R^{-1} S)^T
+  data.joint.topRightCorner(f, s).noalias() =
+      -data.gain * data.joint.bottomRightCorner(s, s);
+  data.joint.bottomLeftCorner(s, f) = data.joint.topRightCorner(f, s).transpose();
+  data.joint.topLeftCorner(f, f).noalias() -=
+      data.joint.topRightCorner(f, s) * data.gain.transpose();
+}
+
+/* ************************************************************************* */
+template <class CLIQUE>
+bool BayesTreeCovariances<CLIQUE>::locate(Key i, Key j, size_t* clique,
+                                          size_t* a, size_t* b) const {
+  const auto li = locations_.find(i), lj = locations_.find(j);
+  if (li == locations_.end() || lj == locations_.end()) return false;
+
+  // Either variable may be the separator variable in the clique of the other
+  *clique = li->second.first;
+  *a = li->second.second;
+  *b = position(*clique, j);
+  if (*b < cliques_[*clique].conditional->size()) return true;
+  *clique = lj->second.first;
+  *a = position(*clique, i);
+  *b = lj->second.second;
+  return *a < cliques_[*clique].conditional->size();
+}
+
+/* ************************************************************************* */
+template <class CLIQUE>
+Matrix BayesTreeCovariances<CLIQUE>::covariance(Key i, Key j) const {
+  size_t clique, a, b;
+  if (!locate(i, j, &clique, &a, &b))
+    throw std::invalid_argument(
+        exists(i) && exists(j)
+            ? "BayesTreeCovariances: variables do not appear together in a "
+              "clique"
+            : "BayesTreeCovariances: variable not in the Bayes tree");
+  return block(clique, a, b);
+}
+
+}  // namespace gtsam
@@ -0,0 +1,335 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    MultifrontalSolver.cpp
+ * @brief   Multifrontal elimination with a cached symbolic structure
+ */
+
+#include <gtsam/linear/MultifrontalSolver.h>
+#include <gtsam/linear/GaussianEliminationTree.h>
+#include <gtsam/linear/GaussianBayesTree.h>
+#include <gtsam/linear/linearExceptions.h>
+#include <gtsam/inference/VariableIndex.h>
+#include <gtsam/inference/inferenceExceptions.h>
+#include <gtsam/base/cholesky.h>
+#include <gtsam/base/treeTraversal-inst.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace gtsam {
+
+/* ************************************************************************* */
+MultifrontalSolver::MultifrontalSolver(const GaussianFactorGraph& gfg,
+                                       const Ordering& ordering)
+    : ordering_(ordering) {
+  initialize(gfg, VariableIndex(gfg));
+}
+
+/* ************************************************************************* */
+MultifrontalSolver::MultifrontalSolver(const GaussianFactorGraph& gfg,
+                                       Ordering::OrderingType orderingType) {
+  const VariableIndex variableIndex(gfg);
+  if (orderingType == Ordering::COLAMD)
+    ordering_ = Ordering::Colamd(variableIndex);
+  else
+    ordering_ = Ordering::Create(orderingType, gfg);
+  initialize(gfg, variableIndex);
+}
+
+/* ************************************************************************* */
+MultifrontalSolver::~MultifrontalSolver() {}
+
+/* ************************************************************************* */
+void MultifrontalSolver::initialize(const GaussianFactorGraph& gfg,
+                                    const VariableIndex& variableIndex) {
+  gttic(MultifrontalSolver_symbolic);
+
+  // Record the layout of the graph, used to check compatibility later
+  FastMap<Key, size_t> keyDims;
+  factorOffsets_.reserve(gfg.size() + 1);
+  factorOffsets_.push_back(0);
+  for (const auto& factor : gfg) {
+    if (factor) {
+      for (auto it = factor->begin(); it != factor->end(); ++it) {
+        keys_.push_back(*it);
+        dims_.push_back(factor->getDim(it));
+        keyDims[*it] = dims_.back();
+      }
+    }
+    factorOffsets_.push_back(keys_.size());
+  }
+
+  // Symbolic elimination
+  const GaussianEliminationTree etree(gfg, variableIndex, ordering_);
+  junctionTree_ = std::make_unique<GaussianJunctionTree>(etree);
+
+  // Factors that are not pulled into any cluster would make elimination fail
+  if (!junctionTree_->remainingFactors().empty()) {
+    KeySet remaining;
+    for (const auto& factor : junctionTree_->remainingFactors())
+      if (factor) remaining.insert(factor->begin(), factor->end());
+    throw InconsistentEliminationRequested(remaining);
+  }
+
+  // Index of every factor in the graph. The same factor may appear more than
+  // once, in which case the indices are handed out in order.
+  FastMap<const GaussianFactor*, std::vector<size_t>> factorIndices;
+  for (size_t i = gfg.size(); i-- > 0;)
+    if (gfg[i]) factorIndices[gfg[i].get()].push_back(i);
+
+  // Collect the clusters in pre-order, with their parents
+  std::vector<std::pair<sharedCluster, size_t>> stack;
+  for (const sharedCluster& root : junctionTree_->roots())
+    stack.emplace_back(root, size_t(-1));
+  while (!stack.empty()) {
+    const auto [cluster, parent] = stack.back();
+    stack.pop_back();
+    const size_t index = clusters_.size();
+    clusters_.push_back(cluster);
+    parents_.push_back(parent);
+    children_.emplace_back();
+    if (parent != size_t(-1)) children_[parent].push_back(index);
+    indices_.emplace(cluster.get(), index);
+    std::vector<size_t> indices;
+    indices.reserve(cluster->factors.size());
+    for (const auto& factor : cluster->factors) {
+      auto& candidates = factorIndices.at(factor.get());
+      indices.push_back(candidates.back());
+      candidates.pop_back();
+    }
+    clusterFactors_.push_back(std::move(indices));
+    for (const sharedCluster& child : cluster->children)
+      stack.emplace_back(child, index);
+  }
+
+  // Frontal and separator dimensions, children before parents
+  const size_t n = clusters_.size();
+  frontalDims_.assign(n, 0);
+  separatorDims_.assign(n, 0);
+  std::vector<KeySet> separators(n);
+  for (size_t c = n; c-- > 0;) {
+    const auto& cluster = *clusters_[c];
+    for (const auto& factor : cluster.factors)
+      separators[c].insert(factor->begin(), factor->end());
+    for (Key j : cluster.orderedFrontalKeys) {
+      separators[c].erase(j);
+      frontalDims_[c] += keyDims[j];
+    }
+    for (Key j : separators[c]) separatorDims_[c] += keyDims[j];
+    if (parents_[c] != size_t(-1))
+      separators[parents_[c]].insert(separators[c].begin(),
+                                     separators[c].end());
+  }
+
+  clusterKeys_.resize(n);
+  for (size_t c = 0; c < n; ++c) {
+    const auto& frontals = clusters_[c]->orderedFrontalKeys;
+    clusterKeys_[c].reserve(frontals.size() + separators[c].size());
+    clusterKeys_[c].assign(frontals.begin(), frontals.end());
+    clusterKeys_[c].insert(clusterKeys_[c].end(), separators[c].begin(),
+                           separators[c].end());
+  }
+}
+
+/* ************************************************************************* */
+bool MultifrontalSolver::compatible(const GaussianFactorGraph& gfg) const {
+  if (gfg.size() + 1 != factorOffsets_.size()) return false;
+  for (size_t i = 0; i < gfg.size(); ++i) {
+    const auto& factor = gfg[i];
+    const size_t begin = factorOffsets_[i], size = factorOffsets_[i + 1] - begin;
+    if (!factor) {
+      if (size != 0) return false;
+      continue;
+    }
+    if (factor->size() != size) return false;
+    for (size_t k = 0; k < size; ++k) {
+      if (factor->keys()[k] != keys_[begin + k] ||
+          static_cast<size_t>(factor->getDim(factor->begin() + k)) !=
+              dims_[begin + k])
+        return false;
+    }
+  }
+  return true;
+}
+
+/* ************************************************************************* */
+GaussianBayesTree::shared_ptr MultifrontalSolver::eliminate(
+    const GaussianFactorGraph& gfg,
+    const GaussianFactorGraph::Eliminate& function) {
+  if (!compatible(gfg))
+    throw std::invalid_argument(
+        "MultifrontalSolver: graph does not match the cached structure");
+
+  // Swap the new factors into the cached clusters
+  for (size_t c = 0; c < clusters_.size(); ++c) {
+    auto& factors = clusters_[c]->factors;
+    const auto& indices = clusterFactors_[c];
+    for (size_t k = 0; k < indices.size(); ++k) factors[k] = gfg[indices[k]];
+  }
+
+  const auto result = junctionTree_->eliminate(function);
+
+  // Do not keep the factors alive beyond this call
+  for (const sharedCluster& cluster : clusters_)
+    for (auto& factor : cluster->factors) factor.reset();
+
+  return result.first;
+}
+
+/* ************************************************************************* */
+void MultifrontalSolver::allocateFronts() {
+  gttic(MultifrontalSolver_allocateFronts);
+  FastMap<Key, size_t> keyDims;
+  for (size_t k = 0; k < keys_.size(); ++k) keyDims[keys_[k]] = dims_[k];
+
+  // Frontal variables of a cluster are contiguous in the solution vector
+  FastMap<Key, size_t> keyOffsets;
+  size_t offset = 0;
+  for (const sharedCluster& cluster : clusters_) {
+    for (Key j : cluster->orderedFrontalKeys) {
+      keyOffsets[j] = offset;
+      offset += keyDims[j];
+    }
+  }
+  solution_.resize(offset);
+
+  const size_t n = clusters_.size();
+  fronts_.resize(n);
+  std::vector<size_t> blockDims;
+  for (size_t c = 0; c < n; ++c) {
+    const KeyVector& keys = clusterKeys_[c];
+    Front& front = fronts_[c];
+    blockDims.clear();
+    front.offsets.clear();
+    for (Key j : keys) {
+      blockDims.push_back(keyDims[j]);
+      front.offsets.push_back(keyOffsets[j]);
+    }
+    front.info = SymmetricBlockMatrix(blockDims, true);
+
+    // Position of our separator variables in the frontal matrix of the parent
+    if (parents_[c] != size_t(-1)) {
+      const KeyVector& parentKeys = clusterKeys_[parents_[c]];
+      const size_t nrFrontals = clusters_[c]->nrFrontals();
+      for (size_t k = nrFrontals; k < keys.size(); ++k)
+        front.parentSlots.push_back(
+            std::find(parentKeys.begin(), parentKeys.end(), keys[k]) -
+            parentKeys.begin());
+      front.parentSlots.push_back(parentKeys.size());
+    }
+  }
+}
+
+/* ************************************************************************* */
+void MultifrontalSolver::factorizeFront(const GaussianFactorGraph& gfg,
+                                        size_t c) {
+  Front& front = fronts_[c];
+  SymmetricBlockMatrix& info = front.info;
+  info.setZero();
+
+  // Add our own factors
+  for (size_t i : clusterFactors_[c])
+    gfg[i]->updateHessian(clusterKeys_[c], &info);
+
+  // Add the remaining factors of the children, left in the lower-right part
+  // of their frontal matrices
+  for (size_t child : children_[c]) {
+    const Front& childFront = fronts_[child];
+    const SymmetricBlockMatrix& childInfo = childFront.info;
+    const DenseIndex nrFrontals = clusters_[child]->nrFrontals();
+    const DenseIndex n = childInfo.nBlocks();
+    for (DenseIndex j = nrFrontals; j < n; ++j) {
+      const DenseIndex J = childFront.parentSlots[j - nrFrontals];
+      for (DenseIndex i = nrFrontals; i < j; ++i)
+        info.updateOffDiagonalBlock(childFront.parentSlots[i - nrFrontals], J,
+                                    childInfo.aboveDiagonalBlock(i, j));
+      info.updateDiagonalBlock(J,
+                               childInfo.diagonalBlock(j).nestedExpression());
+    }
+  }
+
+  // Partial Cholesky, leaves [R S d] in the top rows
+  try {
+    info.choleskyPartial(clusters_[c]->nrFrontals());
+  } catch (const CholeskyFailed&) {
+    throw IndeterminantLinearSystemException(
+        clusters_[c]->orderedFrontalKeys.front());
+  }
+}
+
+/* ************************************************************************* */
+VectorValues MultifrontalSolver::optimizeCholesky(
+    const GaussianFactorGraph& gfg) {
+  gttic(MultifrontalSolver_optimizeCholesky);
+  if (!compatible(gfg))
+    throw std::invalid_argument(
+        "MultifrontalSolver: graph does not match the cached structure");
+  if (hasConstraints(gfg))
+    throw std::invalid_argument(
+        "MultifrontalSolver: constrained noise models are not supported by "
+        "Cholesky");
+  if (fronts_.empty() && !clusters_.empty()) allocateFronts();
+
+  // Factorize, children before parents
+  {
+    gttic(factorize);
+    size_t rootData = size_t(-1);
+    auto visitorPre = [this](const sharedCluster& cluster, size_t&) {
+      return indices_.at(cluster.get());
+    };
+    auto visitorPost = [this, &gfg](const sharedCluster&, size_t& c) {
+      factorizeFront(gfg, c);
+    };
+    TbbOpenMPMixedScope threadLimiter;
+    treeTraversal::DepthFirstForestParallel(*junctionTree_, rootData,
+                                            visitorPre, visitorPost, 10);
+  }
+
+  // Back-substitute, parents before children
+  {
+    gttic(backSubstitute);
+    for (size_t c = 0; c < clusters_.size(); ++c) {
+      Front& front = fronts_[c];
+      SymmetricBlockMatrix& info = front.info;
+      const DenseIndex nrFrontals = clusters_[c]->nrFrontals();
+      const DenseIndex n = info.nBlocks() - 1;
+      auto x = solution_.segment(front.offsets.front(), frontalDims_[c]);
+      x = info.aboveDiagonalRange(0, nrFrontals, n, n + 1).col(0);
+      for (DenseIndex j = nrFrontals; j < n; ++j)
+        x.noalias() -= info.aboveDiagonalRange(0, nrFrontals, j, j + 1) *
+                       solution_.segment(front.offsets[j], info.getDim(j));
+      info.triangularView(0, nrFrontals).solveInPlace(x);
+    }
+  }
+
+  VectorValues result;
+  for (size_t c = 0; c < clusters_.size(); ++c) {
+    const KeyVector& keys = clusterKeys_[c];
+    for (size_t k = 0; k < clusters_[c]->nrFrontals(); ++k)
+      result.emplace(keys[k], solution_.segment(fronts_[c].offsets[k],
+                                                fronts_[c].info.getDim(k)));
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+VectorValues MultifrontalSolver::optimize(
+    const GaussianFactorGraph& gfg,
+    const GaussianFactorGraph::Eliminate& function) {
+  gttic(MultifrontalSolver_optimize);
+  return eliminate(gfg, function)->optimize();
+}
+
+}  // namespace gtsam
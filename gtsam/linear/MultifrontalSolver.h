@@ -0,0 +1,151 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    MultifrontalSolver.h
+ * @brief   Multifrontal elimination with a cached symbolic structure
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/GaussianJunctionTree.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/base/SymmetricBlockMatrix.h>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace gtsam {
+
+/**
+ * Multifrontal elimination of a sequence of GaussianFactorGraphs that share
+ * the same structure, as happens in every iteration of a nonlinear optimizer.
+ *
+ * The symbolic work is done only once, in the constructor: computing the
+ * ordering, building the elimination tree and the junction tree, and the
+ * frontal and separator dimensions of each clique. eliminate() then only
+ * swaps the factors of a new graph into the cached clusters and runs the
+ * numeric elimination. Use compatible() to check whether a graph has the
+ * same factor layout as the one the structure was built for.
+ *
+ * For Cholesky, optimizeCholesky() goes further and keeps the dense frontal
+ * matrix of every clique allocated between calls. Each numeric factorization
+ * then overwrites the frontal matrices in place and back-substitutes directly
+ * from them, without allocating HessianFactors, GaussianConditionals or a
+ * Bayes tree. The price is memory: every frontal matrix, including the
+ * separator part, stays allocated for the lifetime of the solver.
+ * @ingroup linear
+ */
+class GTSAM_EXPORT MultifrontalSolver {
+ public:
+  typedef std::shared_ptr<MultifrontalSolver> shared_ptr;
+  typedef GaussianJunctionTree::sharedNode sharedCluster;
+
+ private:
+  Ordering ordering_;
+  std::unique_ptr<GaussianJunctionTree> junctionTree_;
+
+  /// All clusters in the tree, in pre-order, with the index in the graph of
+  /// each of their factors
+  std::vector<sharedCluster> clusters_;
+  std::vector<std::vector<size_t>> clusterFactors_;
+
+  /// Parent of each cluster in clusters_, or -1 for roots, and children
+  std::vector<size_t> parents_;
+  std::vector<std::vector<size_t>> children_;
+  std::unordered_map<const GaussianJunctionTree::Cluster*, size_t> indices_;
+
+  /// Frontal keys followed by the sorted separator keys of each cluster
+  std::vector<KeyVector> clusterKeys_;
+
+  /// Frontal and separator dimension of each cluster in clusters_
+  std::vector<size_t> frontalDims_, separatorDims_;
+
+  /// Preallocated storage of one cluster for optimizeCholesky()
+  struct Front {
+    SymmetricBlockMatrix info;  ///< Augmented frontal matrix, [R S d] after
+                                ///< elimination, remaining factor below
+    std::vector<DenseIndex> parentSlots;  ///< Block of each separator variable
+                                          ///< and of the RHS in the parent
+    std::vector<size_t> offsets;  ///< Offset of each variable in solution_
+  };
+  std::vector<Front> fronts_;
+  Vector solution_;
+
+  /// Keys and their dimensions of all factors, concatenated, with the start of
+  /// each factor in factorOffsets_, used to check compatibility
+  KeyVector keys_;
+  std::vector<size_t> dims_, factorOffsets_;
+
+ public:
+  /// Build the symbolic structure of \c gfg for the given ordering
+  MultifrontalSolver(const GaussianFactorGraph& gfg, const Ordering& ordering);
+
+  /// Build the symbolic structure of \c gfg, computing an ordering of the
+  /// given type
+  MultifrontalSolver(const GaussianFactorGraph& gfg,
+                     Ordering::OrderingType orderingType = Ordering::COLAMD);
+
+  ~MultifrontalSolver();
+
+  /// Whether \c gfg has the same factors, on the same keys, in the same order
+  /// as the graph the structure was built for
+  bool compatible(const GaussianFactorGraph& gfg) const;
+
+  /**
+   * Eliminate \c gfg using the cached structure. Throws std::invalid_argument
+   * if \c gfg is not compatible.
+   */
+  GaussianBayesTree::shared_ptr eliminate(
+      const GaussianFactorGraph& gfg,
+      const GaussianFactorGraph::Eliminate& function =
+          EliminationTraits<GaussianFactorGraph>::DefaultEliminate);
+
+  /// Eliminate \c gfg using the cached structure and back-substitute
+  VectorValues optimize(const GaussianFactorGraph& gfg,
+                        const GaussianFactorGraph::Eliminate& function =
+                            EliminationTraits<GaussianFactorGraph>::DefaultEliminate);
+
+  /**
+   * Solve \c gfg by multifrontal Cholesky using the cached structure, with
+   * frontal matrices that are allocated on the first call and reused by all
+   * later ones. Throws std::invalid_argument if \c gfg is not compatible or
+   * has constrained noise models, and IndeterminantLinearSystemException if
+   * it is not positive definite.
+   */
+  VectorValues optimizeCholesky(const GaussianFactorGraph& gfg);
+
+  /// The elimination ordering used
+  const Ordering& ordering() const { return ordering_; }
+
+  /// The clusters of the junction tree, parents before children
+  const std::vector<sharedCluster>& clusters() const { return clusters_; }
+
+  /// Sum of the dimensions of the frontal variables of each cluster
+  const std::vector<size_t>& frontalDims() const { return frontalDims_; }
+
+  /// Sum of the dimensions of the separator variables of each cluster
+  const std::vector<size_t>& separatorDims() const { return separatorDims_; }
+
+ private:
+  void initialize(const GaussianFactorGraph& gfg,
+                  const VariableIndex& variableIndex);
+
+  /// Allocate fronts_ and solution_
+  void allocateFronts();
+
+  /// Numeric factorization of cluster c, in place in fronts_[c]
+  void factorizeFront(const GaussianFactorGraph& gfg, size_t c);
+};
+
+}  // namespace gtsam
@@ -0,0 +1,216 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    SparseCholeskySolver.cpp
+ * @brief   Sparse-matrix Cholesky solver with a cached symbolic factorization
+ */
+
+#include <gtsam/linear/SparseCholeskySolver.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/linearExceptions.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace gtsam {
+
+/* ************************************************************************* */
+SparseCholeskySolver::SparseCholeskySolver(const GaussianFactorGraph& gfg,
+                                           const Ordering& ordering)
+    : ordering_(ordering) {
+  gttic_(SparseCholeskySolver_symbolic);
+
+  // Block index of every variable, in elimination order
+  const size_t n = ordering_.size();
+  for (size_t b = 0; b < n; ++b) blocks_.emplace(ordering_[b], b);
+
+  // Dimensions come from the factors
+  dims_.assign(n, 0);
+  for (const auto& factor : gfg) {
+    if (!factor) continue;
+    for (auto it = factor->begin(); it != factor->end(); ++it) {
+      auto block = blocks_.find(*it);
+      if (block == blocks_.end())
+        throw std::invalid_argument(
+            "SparseCholeskySolver: ordering does not contain all variables");
+      dims_[block->second] = factor->getDim(it);
+    }
+  }
+  offsets_.assign(n + 1, 0);
+  for (size_t b = 0; b < n; ++b) offsets_[b + 1] = offsets_[b] + dims_[b];
+
+  // Block rows present in every block column, the diagonal is always there
+  std::vector<std::vector<size_t>> rows(n);
+  for (size_t b = 0; b < n; ++b) rows[b].push_back(b);
+  for (const auto& factor : gfg) {
+    if (!factor) continue;
+    std::vector<size_t> factorBlocks;
+    for (Key key : factor->keys()) factorBlocks.push_back(blocks_.at(key));
+    for (size_t I : factorBlocks)
+      for (size_t J : factorBlocks)
+        if (I < J) rows[J].push_back(I);
+  }
+
+  // Sort the block rows and compute their position within each column
+  columnBlocks_.resize(n);
+  for (size_t J = 0; J < n; ++J) {
+    std::sort(rows[J].begin(), rows[J].end());
+    rows[J].erase(std::unique(rows[J].begin(), rows[J].end()), rows[J].end());
+    size_t offset = 0;
+    for (size_t I : rows[J]) {
+      columnBlocks_[J].emplace_back(I, offset);
+      offset += dims_[I];
+    }
+  }
+
+  // Build the compressed-column structure of the upper triangle directly
+  const size_t N = offsets_[n];
+  hessian_.resize(N, N);
+  std::vector<int> nnz(N);
+  for (size_t J = 0; J < n; ++J) {
+    const size_t above = columnBlocks_[J].back().second;  // rows above diagonal
+    for (size_t k = 0; k < dims_[J]; ++k) nnz[offsets_[J] + k] = above + k + 1;
+  }
+  hessian_.reserve(nnz);
+  for (size_t J = 0; J < n; ++J) {
+    for (size_t k = 0; k < dims_[J]; ++k) {
+      const size_t col = offsets_[J] + k;
+      for (const auto& [I, offset] : columnBlocks_[J]) {
+        const size_t end = (I == J) ? k + 1 : dims_[I];
+        for (size_t r = 0; r < end; ++r)
+          hessian_.insert(offsets_[I] + r, col) = 0.0;
+      }
+    }
+  }
+  hessian_.makeCompressed();
+  gradient_.resize(N);
+
+  // Symbolic factorization, done only once
+  factorization_.analyzePattern(hessian_);
+}
+
+/* ************************************************************************* */
+bool SparseCholeskySolver::compatible(const GaussianFactorGraph& gfg) const {
+  for (const auto& factor : gfg) {
+    if (!factor) continue;
+    std::vector<size_t> factorBlocks;
+    for (auto it = factor->begin(); it != factor->end(); ++it) {
+      auto block = blocks_.find(*it);
+      if (block == blocks_.end() ||
+          dims_[block->second] != static_cast<size_t>(factor->getDim(it)))
+        return false;
+      factorBlocks.push_back(block->second);
+    }
+    for (size_t I : factorBlocks) {
+      for (size_t J : factorBlocks) {
+        if (I >= J) continue;
+        const auto& column = columnBlocks_[J];
+        auto it = std::lower_bound(column.begin(), column.end(),
+                                   std::make_pair(I, size_t(0)));
+        if (it == column.end() || it->first != I) return false;
+      }
+    }
+  }
+  return true;
+}
+
+/* ************************************************************************* */
+size_t SparseCholeskySolver::position(size_t J, size_t slot, size_t row,
+                                      size_t col) const {
+  return hessian_.outerIndexPtr()[offsets_[J] + col] +
+         columnBlocks_[J][slot].second + row;
+}
+
+/* ************************************************************************* */
+void SparseCholeskySolver::assemble(const GaussianFactorGraph& gfg) {
+  gttic_(SparseCholeskySolver_assemble);
+  double* values = hessian_.valuePtr();
+  std::fill(values, values + hessian_.nonZeros(), 0.0);
+  gradient_.setZero();
+
+  for (const auto& factor : gfg) {
+    if (!factor) continue;
+    if (auto jacobian = std::dynamic_pointer_cast<JacobianFactor>(factor))
+      if (jacobian->isConstrained())
+        throw std::invalid_argument(
+            "SparseCholeskySolver: constrained noise models are not supported");
+
+    // Augmented information [A b]^T [A b] of the factor
+    const Matrix info = factor->augmentedInformation();
+    const size_t m = factor->size();
+    std::vector<size_t> factorBlocks(m), factorOffsets(m + 1, 0);
+    for (size_t p = 0; p < m; ++p) {
+      factorBlocks[p] = blocks_.at(factor->keys()[p]);
+      factorOffsets[p + 1] = factorOffsets[p] + dims_[factorBlocks[p]];
+    }
+    const size_t last = factorOffsets[m];
+
+    for (size_t q = 0; q < m; ++q) {
+      const size_t J = factorBlocks[q];
+      const auto& column = columnBlocks_[J];
+      gradient_.segment(offsets_[J], dims_[J]) +=
+          info.block(factorOffsets[q], last, dims_[J], 1);
+      for (size_t p = 0; p < m; ++p) {
+        const size_t I = factorBlocks[p];
+        if (I > J) continue;
+        const size_t slot =
+            std::lower_bound(column.begin(), column.end(),
+                             std::make_pair(I, size_t(0))) - column.begin();
+        for (size_t c = 0; c < dims_[J]; ++c) {
+          const size_t end = (I == J) ? c + 1 : dims_[I];
+          double* dest = values + position(J, slot, 0, c);
+          for (size_t r = 0; r < end; ++r)
+            dest[r] += info(factorOffsets[p] + r, factorOffsets[q] + c);
+        }
+      }
+    }
+  }
+}
+
+/* ************************************************************************* */
+VectorValues SparseCholeskySolver::solve(const GaussianFactorGraph& gfg) {
+  gttic_(SparseCholeskySolver_solve);
+  if (!compatible(gfg))
+    throw std::invalid_argument(
+        "SparseCholeskySolver: graph does not match the cached structure");
+  assemble(gfg);
+
+  // Numeric factorization, reusing the symbolic analysis
+  {
+    gttic_(SparseCholeskySolver_factorize);
+    factorization_.factorize(hessian_);
+  }
+  // Report the variable at the first non-positive pivot
+  const Vector& D = factorization_.vectorD();
+  for (Eigen::Index i = 0; i < D.size(); ++i) {
+    if (!(D(i) > 0.0)) {
+      const size_t b = std::upper_bound(offsets_.begin(), offsets_.end(),
+                                        static_cast<size_t>(i)) -
+                       offsets_.begin() - 1;
+      throw IndeterminantLinearSystemException(ordering_[b]);
+    }
+  }
+  if (factorization_.info() != Eigen::Success)
+    throw IndeterminantLinearSystemException(ordering_.front());
+
+  const Vector x = factorization_.solve(gradient_);
+
+  VectorValues result;
+  for (size_t b = 0; b < ordering_.size(); ++b)
+    result.emplace(ordering_[b], x.segment(offsets_[b], dims_[b]));
+  return result;
+}
+
+}  // namespace gtsam
@@ -0,0 +1,99 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    SparseCholeskySolver.h
+ * @brief   Sparse-matrix Cholesky solver with a cached symbolic factorization
+ */
+
+#pragma once
+
+#include <gtsam/linear/SparseEigen.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/inference/Ordering.h>
+
+#include <Eigen/SparseCholesky>
+
+#include <memory>
+#include <vector>
+
+namespace gtsam {
+
+/**
+ * Solves a GaussianFactorGraph by assembling its Hessian into a single sparse
+ * matrix in compressed-column form and factorizing it with a sparse Cholesky
+ * (LDL^T) factorization, rather than by multifrontal elimination.
+ *
+ * The block sparsity pattern and the symbolic analysis are computed once, in
+ * the constructor. Each call to solve() only overwrites the numeric values of
+ * the sparse matrix and refactorizes, so in nonlinear optimization the
+ * symbolic work is shared by all iterations as long as the graph structure
+ * does not change. The diagonal block of every variable is always part of the
+ * pattern, so damping in Levenberg-Marquardt does not change the structure.
+ *
+ * Constrained noise models are not supported, as for any Cholesky solver.
+ * @ingroup linear
+ */
+class GTSAM_EXPORT SparseCholeskySolver {
+ public:
+  typedef std::shared_ptr<SparseCholeskySolver> shared_ptr;
+
+ private:
+  typedef Eigen::SimplicialLDLT<SparseEigen, Eigen::Upper,
+                                Eigen::NaturalOrdering<int>>
+      Factorization;
+
+  Ordering ordering_;                  ///< Elimination ordering = column order
+  FastMap<Key, size_t> blocks_;        ///< Key -> block index in ordering_
+  std::vector<size_t> dims_;           ///< Dimension of each block
+  std::vector<size_t> offsets_;        ///< First column of each block
+
+  /// For every block column J, the block rows I <= J present in it, paired
+  /// with the position of block I inside every column of J.
+  std::vector<std::vector<std::pair<size_t, size_t>>> columnBlocks_;
+
+  SparseEigen hessian_;                ///< Upper triangle of the Hessian
+  Vector gradient_;                    ///< Linear term A^T b
+  Factorization factorization_;        ///< Symbolic + numeric factorization
+
+ public:
+  /**
+   * Compute the block sparsity pattern of \c gfg and its symbolic
+   * factorization, eliminating variables in the order given by \c ordering.
+   */
+  SparseCholeskySolver(const GaussianFactorGraph& gfg, const Ordering& ordering);
+
+  /// Whether every factor in \c gfg fits in the cached sparsity pattern
+  bool compatible(const GaussianFactorGraph& gfg) const;
+
+  /**
+   * Assemble the Hessian of \c gfg into the cached pattern, factorize it
+   * numerically and solve for the update. Throws std::invalid_argument if
+   * \c gfg is not compatible and IndeterminantLinearSystemException if the
+   * system is not positive definite.
+   */
+  VectorValues solve(const GaussianFactorGraph& gfg);
+
+  /// The elimination ordering used
+  const Ordering& ordering() const { return ordering_; }
+
+  /// Number of structural non-zeros in the upper triangle of the Hessian
+  size_t nnz() const { return hessian_.nonZeros(); }
+
+ private:
+  /// Position in hessian_.valuePtr() of entry (row, col) of block (I, J)
+  size_t position(size_t J, size_t slot, size_t row, size_t col) const;
+
+  /// Fill hessian_ and gradient_ with the numeric values of \c gfg
+  void assemble(const GaussianFactorGraph& gfg);
+};
+
+}  // namespace gtsam
@@ -21,9 +21,12 @@
 #include <gtsam/linear/GaussianConditional.h>
 #include <gtsam/base/treeTraversal-inst.h>
 
+#include <algorithm>
 #include <memory>
-
 #include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace gtsam
 {
@@ -32,126 +35,111 @@ namespace gtsam
     namespace linearAlgorithms
     {
       /* ************************************************************************* */
-      struct OptimizeData {
-        OptimizeData* parentData = nullptr;
-        FastMap<Key, VectorValues::const_iterator> cliqueResults;
-        //VectorValues ancestorResults;
-        //VectorValues results;
-      };
-
-      /* ************************************************************************* */
-      /** Pre-order visitor for back-substitution in a Bayes tree.  The visitor function operator()()
-      *  optimizes the clique given the solution for the parents, and returns the solution for the
-      *  clique's frontal variables.  In addition, it adds the solution to a global collected
-      *  solution that will finally be returned to the user.  The reason we pass the individual
-      *  clique solutions between nodes is to avoid log(n) lookups over all variables, they instead
-      *  then are only over a node's parent variables. */
+      /** Visitor for back-substitution in a Bayes tree.  The visitor function operator()()
+      *  optimizes the clique given the solution for its parents, and writes the solution for the
+      *  clique's frontal variables into the preallocated result.  The positions of each clique's
+      *  parent and frontal entries in the result are found once, before the traversal, by
+      *  passing them down from the parent clique so lookups are only over a clique's parents.
+      *  Cliques in different subtrees can then be solved concurrently. */
       template<class CLIQUE>
       struct OptimizeClique
       {
-        VectorValues collectedResult;
+        /// Entries in the result for the variables of one clique
+        struct Slots {
+          FastVector<Vector*> frontals;
+          FastVector<Vector*> parents;
+        };
+
+        std::unordered_map<const CLIQUE*, Slots> slots;
+        DenseIndex maxDim = 0;  ///< Largest parent plus frontal dimension over all cliques
 
-        OptimizeData operator()(
-          const std::shared_ptr<CLIQUE>& clique,
-          OptimizeData& parentData)
+        void operator()(const std::shared_ptr<CLIQUE>& clique) const
         {
-          OptimizeData myData;
-          myData.parentData = &parentData;
-          // Take any ancestor results we'll need
-          for(Key parent: clique->conditional_->parents())
-            myData.cliqueResults.emplace(parent, myData.parentData->cliqueResults.at(parent));
-
-          // Solve and store in our results
-          {
-            GaussianConditional& c = *clique->conditional();
-            // Solve matrix
-            Vector xS;
-            {
-              // Count dimensions of vector
-              DenseIndex dim = 0;
-              FastVector<VectorValues::const_iterator> parentPointers;
-              parentPointers.reserve(clique->conditional()->nrParents());
-              for(Key parent: clique->conditional()->parents()) {
-                parentPointers.push_back(myData.cliqueResults.at(parent));
-                dim += parentPointers.back()->second.size();
-              }
-
-              // Fill parent vector
-              xS.resize(dim);
-              DenseIndex vectorPos = 0;
-              for(const VectorValues::const_iterator& parentPointer: parentPointers) {
-                const Vector& parentVector = parentPointer->second;
-                xS.block(vectorPos,0,parentVector.size(),1) = parentVector.block(0,0,parentVector.size(),1);
-                vectorPos += parentVector.size();
-              }
-            }
-
-            // NOTE(gareth): We can no longer write: xS = b - S * xS
-            // This is because Eigen (as of 3.3) no longer evaluates S * xS into
-            // a temporary, and the operation trashes valus in xS.
-            // See: http://eigen.tuxfamily.org/index.php?title=3.3
-            const Vector rhs = c.getb() - c.S() * xS;
-
-            // TODO(gareth): Inline instantiation of Eigen::Solve and check flag
-            const Vector solution = c.R().triangularView<Eigen::Upper>().solve(rhs);
-
-            // Check for indeterminant solution
-            if(solution.hasNaN()) throw IndeterminantLinearSystemException(c.keys().front());
-
-            // Insert solution into a VectorValues
-            DenseIndex vectorPosition = 0;
-            for(GaussianConditional::const_iterator frontal = c.beginFrontals(); frontal != c.endFrontals(); ++frontal) {
-              auto result = collectedResult.emplace(*frontal, solution.segment(vectorPosition, c.getDim(frontal)));
-              if(!result.second)
-                  throw std::runtime_error(
-                      "Internal error while optimizing clique. Trying to insert key '" + DefaultKeyFormatter(*frontal)
-                      + "' that exists.");
-
-              VectorValues::const_iterator r = result.first;
-              myData.cliqueResults.emplace(r->first, r);
-              vectorPosition += c.getDim(frontal);
-            }
+          const GaussianConditional& c = *clique->conditional();
+          const Slots& cliqueSlots = slots.at(clique.get());
+
+          // Per-thread scratch for the parent values and the solution, sized once for the
+          // largest clique
+          static thread_local Vector buffer;
+          if(buffer.size() < maxDim) buffer.resize(maxDim);
+          const DenseIndex nrParentDims = c.S().cols(), nrFrontalDims = c.R().rows();
+
+          // Fill parent vector
+          auto xS = buffer.head(nrParentDims);
+          DenseIndex vectorPos = 0;
+          for(const Vector* parentVector: cliqueSlots.parents) {
+            xS.segment(vectorPos, parentVector->size()) = *parentVector;
+            vectorPos += parentVector->size();
           }
-          return myData;
-        }
-      };
 
-      /* ************************************************************************* */
-      //OptimizeData OptimizePreVisitor(const GaussianBayesTreeClique::shared_ptr& clique, OptimizeData& parentData)
-      //{
-      //  // Create data - holds a pointer to our parent, a copy of parent solution, and our results
-      //  OptimizeData myData;
-      //  myData.parentData = parentData;
-      //  // Take any ancestor results we'll need
-      //  for(Key parent: clique->conditional_->parents())
-      //    myData.ancestorResults.insert(parent, myData.parentData->ancestorResults[parent]);
-      //  // Solve and store in our results
-      //  myData.results.insert(clique->conditional()->solve(myData.ancestorResults));
-      //  myData.ancestorResults.insert(myData.results);
-      //  return myData;
-      //}
+          // Solve R * x = b - S * xS, in a part of the buffer that does not alias xS
+          auto solution = buffer.segment(nrParentDims, nrFrontalDims);
+          solution.noalias() = c.getb() - c.S() * xS;
+          c.R().triangularView<Eigen::Upper>().solveInPlace(solution);
 
-      /* ************************************************************************* */
-      //void OptimizePostVisitor(const GaussianBayesTreeClique::shared_ptr& clique, OptimizeData& myData)
-      //{
-      //  // Conglomerate our results to the parent
-      //  myData.parentData->results.insert(myData.results);
-      //}
+          // Check for indeterminant solution
+          if(solution.hasNaN()) throw IndeterminantLinearSystemException(c.keys().front());
+
+          // Write the solution into the preallocated entries
+          DenseIndex vectorPosition = 0;
+          for(Vector* frontalVector: cliqueSlots.frontals) {
+            *frontalVector = solution.segment(vectorPosition, frontalVector->size());
+            vectorPosition += frontalVector->size();
+          }
+        }
+      };
 
       /* ************************************************************************* */
       template<class BAYESTREE>
       VectorValues optimizeBayesTree(const BAYESTREE& bayesTree)
       {
         gttic(linear_optimizeBayesTree);
-        //internal::OptimizeData rootData; // Will hold final solution
-        //treeTraversal::DepthFirstForest(*this, rootData, internal::OptimizePreVisitor, internal::OptimizePostVisitor);
-        //return rootData.results;
-        OptimizeData rootData;
-        OptimizeClique<typename BAYESTREE::Clique> preVisitor;
-        treeTraversal::no_op postVisitor;
+        typedef typename BAYESTREE::Clique Clique;
+        typedef typename BAYESTREE::sharedClique sharedClique;
+        typedef FastMap<Key, Vector*> Entries;
+
+        // Allocate the solution for all frontal variables up front, and give each clique the
+        // positions of its entries.  Each clique receives the entries of its parent clique's
+        // variables, which include all of its own parents.
+        VectorValues result;
+        OptimizeClique<Clique> visitor;
+        std::vector<std::pair<sharedClique, std::shared_ptr<const Entries> > > stack;
+        for(const sharedClique& root: bayesTree.roots())
+          stack.emplace_back(root, nullptr);
+        while(!stack.empty()) {
+          const auto [clique, parentEntries] = stack.back();
+          stack.pop_back();
+          const GaussianConditional& c = *clique->conditional();
+          auto& cliqueSlots = visitor.slots[clique.get()];
+          cliqueSlots.frontals.reserve(c.nrFrontals());
+          for(GaussianConditional::const_iterator frontal = c.beginFrontals(); frontal != c.endFrontals(); ++frontal) {
+            const auto inserted = result.emplace(*frontal, Vector(c.getDim(frontal)));
+            if(!inserted.second)
+              throw std::runtime_error(
+                  "Internal error while optimizing clique. Trying to insert key '" + DefaultKeyFormatter(*frontal)
+                  + "' that exists.");
+            cliqueSlots.frontals.push_back(&inserted.first->second);
+          }
+          cliqueSlots.parents.reserve(c.nrParents());
+          for(Key parent: c.parents())
+            cliqueSlots.parents.push_back(parentEntries->at(parent));
+          visitor.maxDim = std::max(visitor.maxDim, DenseIndex(c.S().cols() + c.R().rows()));
+
+          if(!clique->children.empty()) {
+            auto entries = std::make_shared<Entries>();
+            for(size_t i = 0; i < c.nrFrontals(); ++i)
+              entries->emplace(c.keys()[i], cliqueSlots.frontals[i]);
+            for(size_t i = 0; i < c.nrParents(); ++i)
+              entries->emplace(c.keys()[c.nrFrontals() + i], cliqueSlots.parents[i]);
+            for(const sharedClique& child: clique->children)
+              stack.emplace_back(child, entries);
+          }
+        }
+
+        // Back-substitute from the roots, solving cliques in different subtrees in parallel
         TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
-        treeTraversal::DepthFirstForestParallel(bayesTree, rootData, preVisitor, postVisitor);
-        return preVisitor.collectedResult;
+        treeTraversal::ForestParallelTopDown(bayesTree, visitor);
+        return result;
       }
     }
   }
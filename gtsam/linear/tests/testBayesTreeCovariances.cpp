@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    testBayesTreeCovariances.cpp
+ * @brief   Unit tests for BayesTreeCovariances
+ */
+
+#include <gtsam/linear/BayesTreeCovariances.h>
+#include <gtsam/linear/GaussianBayesTree.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+
+#include <gtsam/base/TestableAssertions.h>
+#include <CppUnitLite/TestHarness.h>
+
+using namespace std;
+using namespace gtsam;
+
+namespace {
+const SharedDiagonal model2 = noiseModel::Isotropic::Sigma(2, 0.5);
+
+// A binary tree of 2D variables with two loops, so there are several cliques
+GaussianFactorGraph createTree(double scale) {
+  GaussianFactorGraph gfg;
+  gfg.add(0, scale * I_2x2, Vector2(1, 2), model2);
+  for (Key j = 1; j < 15; ++j) {
+    const Key parent = (j - 1) / 2;
+    gfg.add(parent, -I_2x2, j, (Matrix2() << scale, 0.1, 0, 1).finished(),
+            Vector2(0.1 * j, -0.2), model2);
+  }
+  gfg.add(7, -I_2x2, 8, I_2x2, Vector2(1, 1), model2);
+  gfg.add(3, (Matrix2() << 1, 0, 0.5, scale).finished(), 5, -I_2x2,
+          Vector2(0, 1), model2);
+  return gfg;
+}
+
+// Block (i, j) of the inverse of the dense information matrix
+Matrix denseCovariance(const GaussianFactorGraph& gfg, Key i, Key j) {
+  const Ordering ordering(gfg.keys());
+  const Matrix covariance = gfg.hessian(ordering).first.inverse();
+  return covariance.block<2, 2>(2 * i, 2 * j);
+}
+}  // namespace
+
+/* ************************************************************************* */
+TEST(BayesTreeCovariances, marginals) {
+  const GaussianFactorGraph gfg = createTree(1.0);
+  const GaussianBayesTree::shared_ptr bayesTree = gfg.eliminateMultifrontal();
+  BayesTreeCovariances<GaussianBayesTreeClique> covariances(*bayesTree);
+  EXPECT_LONGS_EQUAL(bayesTree->size(), covariances.cliques());
+
+  const auto all = covariances.marginalCovariances();
+  EXPECT_LONGS_EQUAL(15, all.size());
+  for (Key j = 0; j < 15; ++j) {
+    EXPECT(covariances.exists(j));
+    EXPECT(assert_equal(denseCovariance(gfg, j, j),
+                        covariances.marginalCovariance(j), 1e-9));
+    EXPECT(assert_equal(all.at(j), covariances.marginalCovariance(j)));
+  }
+
+  // Off-diagonal blocks of variables in the same clique, in either order
+  size_t found = 0;
+  for (Key i = 0; i < 15; ++i) {
+    for (Key j = 0; j < 15; ++j) {
+      if (i == j) continue;
+      try {
+        EXPECT(assert_equal(denseCovariance(gfg, i, j),
+                            covariances.covariance(i, j), 1e-9));
+        ++found;
+      } catch (const std::invalid_argument&) {
+      }
+    }
+  }
+  EXPECT(found > 0);
+  EXPECT(found < 15 * 14);
+  CHECK_EXCEPTION(covariances.covariance(0, 99), std::invalid_argument);
+}
+
+/* ************************************************************************* */
+TEST(BayesTreeCovariances, update) {
+  const GaussianFactorGraph gfg = createTree(1.0);
+  const GaussianBayesTree::shared_ptr bayesTree = gfg.eliminateMultifrontal();
+  BayesTreeCovariances<GaussianBayesTreeClique> covariances(*bayesTree);
+  EXPECT_LONGS_EQUAL(0, covariances.cliquesReused());
+
+  // A copy of the tree shares its conditionals, which are all reused
+  const GaussianBayesTree copy = *bayesTree;
+  covariances.update(copy);
+  EXPECT_LONGS_EQUAL(copy.size(), covariances.cliquesReused());
+  EXPECT(assert_equal(denseCovariance(gfg, 7, 7),
+                      covariances.marginalCovariance(7), 1e-9));
+
+  // A new elimination has new conditionals
+  const GaussianFactorGraph gfg2 = createTree(2.0);
+  covariances.update(*gfg2.eliminateMultifrontal());
+  EXPECT_LONGS_EQUAL(0, covariances.cliquesReused());
+  for (Key j = 0; j < 15; ++j)
+    EXPECT(assert_equal(denseCovariance(gfg2, j, j),
+                        covariances.marginalCovariance(j), 1e-9));
+}
+
+/* ************************************************************************* */
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
+/* ************************************************************************* */
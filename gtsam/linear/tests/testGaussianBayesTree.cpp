@@ -127,6 +127,23 @@ TEST( GaussianBayesTree, optimizeMultiFrontal )
   EXPECT(assert_equal(expected,actual));
 }
 
+/* ************************************************************************* */
+TEST(GaussianBayesTree, optimizeWideTree) {
+  // A balanced binary tree of variables gives many cliques, enough for the
+  // back-substitution to run in parallel
+  const SharedDiagonal model = noiseModel::Isotropic::Sigma(2, 0.5);
+  GaussianFactorGraph gfg;
+  gfg.add(0, I_2x2, Vector2(1, 2), model);
+  for (Key j = 1; j < 255; ++j)
+    gfg.add((j - 1) / 2, -I_2x2, j, (Matrix2() << 1, 0.1 * j, 0, 1).finished(),
+            Vector2(0.01 * j, -0.02 * j), model);
+
+  const VectorValues expected = gfg.eliminateSequential()->optimize();
+  const GaussianBayesTree::shared_ptr bayesTree = gfg.eliminateMultifrontal();
+  EXPECT(bayesTree->size() > 1);
+  EXPECT(assert_equal(expected, bayesTree->optimize(), 1e-9));
+}
+
 /* ************************************************************************* */
 TEST(GaussianBayesTree, complicatedMarginal) {
   // Create the conditionals to go in the BayesTree
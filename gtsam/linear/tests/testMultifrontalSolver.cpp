@@ -0,0 +1,122 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    testMultifrontalSolver.cpp
+ * @brief   Unit tests for MultifrontalSolver
+ */
+
+#include <gtsam/linear/MultifrontalSolver.h>
+#include <gtsam/linear/GaussianBayesTree.h>
+#include <gtsam/linear/linearExceptions.h>
+
+#include <gtsam/base/TestableAssertions.h>
+#include <CppUnitLite/TestHarness.h>
+
+using namespace std;
+using namespace gtsam;
+
+namespace {
+const SharedDiagonal model2 = noiseModel::Isotropic::Sigma(2, 0.5);
+
+// Chain x0 - x1 - x2 - x3 with a prior on x0, x3 is one-dimensional
+GaussianFactorGraph createChain(double scale) {
+  GaussianFactorGraph gfg;
+  gfg.add(0, scale * I_2x2, Vector2(1, 2), model2);
+  gfg.add(0, -I_2x2, 1, scale * I_2x2, Vector2(0.5, 0.1), model2);
+  gfg.add(1, -I_2x2, 2, (Matrix2() << 1, 2, 0, 1).finished(), Vector2(3, -1),
+          model2);
+  gfg.add(2, -I_2x2, 3, Vector2(scale, 1), Vector2(-0.3, 0.2), model2);
+  return gfg;
+}
+}  // namespace
+
+/* ************************************************************************* */
+TEST(MultifrontalSolver, structure) {
+  const GaussianFactorGraph gfg = createChain(1.0);
+  MultifrontalSolver solver(gfg, Ordering{0, 1, 2, 3});
+  EXPECT(assert_equal(Ordering{0, 1, 2, 3}, solver.ordering()));
+
+  // A chain is a single clique containing all variables
+  size_t frontalDim = 0;
+  for (size_t d : solver.frontalDims()) frontalDim += d;
+  EXPECT_LONGS_EQUAL(7, frontalDim);
+  EXPECT_LONGS_EQUAL(solver.clusters().size(), solver.separatorDims().size());
+  EXPECT_LONGS_EQUAL(0, solver.separatorDims().front());  // the root
+}
+
+/* ************************************************************************* */
+TEST(MultifrontalSolver, optimize) {
+  const GaussianFactorGraph gfg = createChain(1.0);
+  MultifrontalSolver solver(gfg);
+  EXPECT(solver.compatible(gfg));
+  EXPECT(assert_equal(gfg.optimize(), solver.optimize(gfg), 1e-9));
+
+  // Same structure, new numbers, with QR as well
+  const GaussianFactorGraph gfg2 = createChain(3.0);
+  EXPECT(solver.compatible(gfg2));
+  EXPECT(assert_equal(gfg2.optimize(), solver.optimize(gfg2), 1e-9));
+  EXPECT(assert_equal(gfg2.optimize(),
+                      solver.optimize(gfg2, EliminateQR), 1e-9));
+  EXPECT(assert_equal(*gfg2.eliminateMultifrontal(solver.ordering()),
+                      *solver.eliminate(gfg2), 1e-9));
+
+  // Adding a factor changes the structure
+  GaussianFactorGraph gfg3 = gfg2;
+  gfg3.add(3, Vector2(1, 1), Vector2(0, 0), model2);
+  EXPECT(!solver.compatible(gfg3));
+  CHECK_EXCEPTION(solver.optimize(gfg3), std::invalid_argument);
+
+  // As does connecting different variables
+  GaussianFactorGraph gfg4 = gfg2;
+  gfg4.replace(3, std::make_shared<JacobianFactor>(
+                      1, -I_2x2, 3, Vector2(1, 1), Vector2(0, 0), model2));
+  EXPECT(!solver.compatible(gfg4));
+}
+
+/* ************************************************************************* */
+TEST(MultifrontalSolver, optimizeCholesky) {
+  // A binary tree with some loops, so there are several cliques
+  auto createTree = [](double scale) {
+    GaussianFactorGraph gfg;
+    gfg.add(0, scale * I_2x2, Vector2(1, 2), model2);
+    for (Key j = 1; j < 15; ++j) {
+      const Key parent = (j - 1) / 2;
+      gfg.add(parent, -I_2x2, j, scale * I_2x2, Vector2(0.1 * j, -0.2), model2);
+    }
+    gfg.add(7, -I_2x2, 8, I_2x2, Vector2(1, 1), model2);
+    gfg.add(3, (Matrix2() << 1, 0, 0, scale).finished(), 5, -I_2x2,
+            Vector2(0, 1), model2);
+    return gfg;
+  };
+
+  const GaussianFactorGraph gfg = createTree(1.0);
+  MultifrontalSolver solver(gfg);
+  EXPECT(solver.clusters().size() > 1);
+  EXPECT(assert_equal(gfg.optimize(), solver.optimizeCholesky(gfg), 1e-9));
+
+  // Second call reuses the frontal matrices
+  const GaussianFactorGraph gfg2 = createTree(2.0);
+  EXPECT(assert_equal(gfg2.optimize(), solver.optimizeCholesky(gfg2), 1e-9));
+  EXPECT(assert_equal(gfg2.optimize(), solver.optimize(gfg2), 1e-9));
+
+  // Rank deficient
+  const GaussianFactorGraph gfg3 = createTree(0.0);
+  CHECK_EXCEPTION(solver.optimizeCholesky(gfg3),
+                  IndeterminantLinearSystemException);
+}
+
+/* ************************************************************************* */
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
+/* ************************************************************************* */
@@ -0,0 +1,96 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    testSparseCholeskySolver.cpp
+ * @brief   Unit tests for SparseCholeskySolver
+ */
+
+#include <gtsam/linear/SparseCholeskySolver.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/linearExceptions.h>
+
+#include <gtsam/base/TestableAssertions.h>
+#include <CppUnitLite/TestHarness.h>
+
+using namespace std;
+using namespace gtsam;
+
+namespace {
+const SharedDiagonal model2 = noiseModel::Isotropic::Sigma(2, 0.5);
+
+// Chain x0 - x1 - x2 with a prior on x0 and a loop x0 - x2
+GaussianFactorGraph createChain(double scale) {
+  GaussianFactorGraph gfg;
+  gfg.add(0, scale * I_2x2, Vector2(1, 2), model2);
+  gfg.add(0, -I_2x2, 1, scale * I_2x2, Vector2(0.5, 0.1), model2);
+  gfg.add(1, -I_2x2, 2, (Matrix2() << 1, 2, 0, 1).finished(), Vector2(3, -1),
+          model2);
+  gfg.add(0, (Matrix(2, 2) << 1, 0, 0, 2).finished(), 2, -scale * I_2x2,
+          Vector2(-0.3, 0.2), model2);
+  return gfg;
+}
+}  // namespace
+
+/* ************************************************************************* */
+TEST(SparseCholeskySolver, solve) {
+  const GaussianFactorGraph gfg = createChain(1.0);
+  const Ordering ordering{2, 0, 1};
+  SparseCholeskySolver solver(gfg, ordering);
+  EXPECT(solver.compatible(gfg));
+  // Upper triangle: 3 diagonal 2x2 blocks (3 entries each), 3 off-diagonal
+  EXPECT_LONGS_EQUAL(3 * 3 + 3 * 4, solver.nnz());
+  EXPECT(assert_equal(gfg.optimize(), solver.solve(gfg), 1e-9));
+}
+
+/* ************************************************************************* */
+TEST(SparseCholeskySolver, reuse) {
+  const Ordering ordering{0, 1, 2};
+  SparseCholeskySolver solver(createChain(1.0), ordering);
+
+  // Same structure, different numbers: reuses the symbolic factorization
+  const GaussianFactorGraph gfg2 = createChain(3.0);
+  EXPECT(solver.compatible(gfg2));
+  EXPECT(assert_equal(gfg2.optimize(), solver.solve(gfg2), 1e-9));
+
+  // Extra unary factors (as added by damping) keep the structure
+  GaussianFactorGraph damped = gfg2;
+  for (Key j : ordering) damped.add(j, 10 * I_2x2, Vector2::Zero(), model2);
+  EXPECT(solver.compatible(damped));
+  EXPECT(assert_equal(damped.optimize(), solver.solve(damped), 1e-9));
+
+  // A factor on a new pair of variables does not fit
+  GaussianFactorGraph chain;
+  chain.add(0, I_2x2, Vector2(1, 2), model2);
+  chain.add(0, -I_2x2, 1, I_2x2, Vector2(0.5, 0.1), model2);
+  chain.add(1, -I_2x2, 2, I_2x2, Vector2(3, -1), model2);
+  SparseCholeskySolver chainSolver(chain, ordering);
+  EXPECT(!chainSolver.compatible(gfg2));
+  CHECK_EXCEPTION(chainSolver.solve(gfg2), std::invalid_argument);
+}
+
+/* ************************************************************************* */
+TEST(SparseCholeskySolver, indeterminant) {
+  // x1 is not constrained at all in the second dimension
+  GaussianFactorGraph gfg;
+  gfg.add(0, I_2x2, Vector2(1, 2), model2);
+  gfg.add(0, -I_2x2, 1, (Matrix2() << 1, 0, 0, 0).finished(), Vector2(0, 0),
+          model2);
+  SparseCholeskySolver solver(gfg, Ordering{0, 1});
+  CHECK_EXCEPTION(solver.solve(gfg), IndeterminantLinearSystemException);
+}
+
+/* ************************************************************************* */
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
+/* ************************************************************************* */
@@ -115,6 +115,29 @@ void PreintegratedCombinedMeasurements::integrateMeasurement(
   Matrix93 B, C;  // Jacobian of state wrpt accel bias and omega bias respectively.
   PreintegrationType::update(measuredAcc, measuredOmega, dt, &A, &B, &C);
 
+  propagateCovariance(A, B, C, dt, &preintMeasCov_);
+}
+
+//------------------------------------------------------------------------------
+void PreintegratedCombinedMeasurements::integrateMeasurements(
+    const Matrix& measuredAccs, const Matrix& measuredOmegas, const Vector& dts) {
+  CheckMeasurements(measuredAccs, measuredOmegas, dts,
+                    "PreintegratedCombinedMeasurements::integrateMeasurements");
+
+  Matrix9 A;
+  Matrix93 B, C;
+  for (Eigen::Index j = 0; j < dts.size(); j++) {
+    const double dt = dts(j);
+    PreintegrationType::update(measuredAccs.col(j), measuredOmegas.col(j), dt,
+                               &A, &B, &C);
+    propagateCovariance(A, B, C, dt, &preintMeasCov_);
+  }
+}
+
+//------------------------------------------------------------------------------
+void PreintegratedCombinedMeasurements::propagateCovariance(const Matrix9& A,
+    const Matrix93& B, const Matrix93& C, double dt,
+    Eigen::Matrix<double, 15, 15>* cov) const {
   // Update preintegrated measurements covariance: as in [2] we consider a first
   // order propagation that can be seen as a prediction phase in an EKF
   // framework. In this implementation, in contrast to [2], we consider the
@@ -140,7 +163,7 @@ void PreintegratedCombinedMeasurements::integrateMeasurement(
   F.block<6, 6>(9, 9) = I_6x6;
 
   // Update the uncertainty on the state (matrix F in [4]).
-  preintMeasCov_ = F * preintMeasCov_ * F.transpose();
+  *cov = F * (*cov) * F.transpose();
 
   // propagate uncertainty
   // TODO(frank): use noiseModel routine so we can have arbitrary noise models.
@@ -193,7 +216,7 @@ void PreintegratedCombinedMeasurements::integrateMeasurement(
       (vel_H_acc * (aCov / dt) * pos_H_acc.transpose()) +
       (vel_H_biasAccInit * bInitCov11 * pos_H_biasAccInit.transpose());
 
-  preintMeasCov_.noalias() += G_measCov_Gt;
+  cov->noalias() += G_measCov_Gt;
 }
 
 //------------------------------------------------------------------------------
@@ -79,6 +79,11 @@ class GTSAM_EXPORT PreintegratedCombinedMeasurements
 
   friend class CombinedImuFactor;
 
+  /// First-order propagation of cov through one measurement with Jacobians A, B, C
+  void propagateCovariance(const Matrix9& A, const Matrix93& B,
+                           const Matrix93& C, double dt,
+                           Eigen::Matrix<double, 15, 15>* cov) const;
+
  public:
   /// @name Constructors
   /// @{
@@ -166,6 +171,15 @@ class GTSAM_EXPORT PreintegratedCombinedMeasurements
                             const Vector3& measuredOmega,
                             const double dt) override;
 
+  /**
+   * Add a buffer of measurements, in matrix columns, with time intervals dts.
+   * Equivalent to calling integrateMeasurement for each column, but updates
+   * the preintegrated state without virtual calls.
+   */
+  void integrateMeasurements(const Matrix& measuredAccs,
+                             const Matrix& measuredOmegas,
+                             const Vector& dts) override;
+
   /// @}
 
  private:
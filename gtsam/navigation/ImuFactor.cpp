@@ -50,18 +50,8 @@ void PreintegratedImuMeasurements::resetIntegration() {
 }
 
 //------------------------------------------------------------------------------
-void PreintegratedImuMeasurements::integrateMeasurement(
-    const Vector3& measuredAcc, const Vector3& measuredOmega, double dt) {
-  if (dt <= 0) {
-    throw std::runtime_error(
-        "PreintegratedImuMeasurements::integrateMeasurement: dt <=0");
-  }
-
-  // Update preintegrated measurements (also get Jacobian)
-  Matrix9 A;  // overall Jacobian wrt preintegrated measurements (df/dx)
-  Matrix93 B, C;  // Jacobian of state wrpt accel bias and omega bias respectively.
-  PreintegrationType::update(measuredAcc, measuredOmega, dt, &A, &B, &C);
-
+void PreintegratedImuMeasurements::propagateCovariance(const Matrix9& A,
+    const Matrix93& B, const Matrix93& C, double dt, Matrix9* cov) const {
   // first order covariance propagation:
   // as in [2] we consider a first order propagation that can be seen as a
   // prediction phase in EKF
@@ -74,27 +64,44 @@ void PreintegratedImuMeasurements::integrateMeasurement(
 
   // (1/dt) allows to pass from continuous time noise to discrete time noise
   // Update the uncertainty on the state (matrix A in [4]).
-  preintMeasCov_ = A * preintMeasCov_ * A.transpose();
+  *cov = A * (*cov) * A.transpose();
   // These 2 updates account for uncertainty on the IMU measurement (matrix B in [4]).
-  preintMeasCov_.noalias() += B * (aCov / dt) * B.transpose();
-  preintMeasCov_.noalias() += C * (wCov / dt) * C.transpose();
+  cov->noalias() += B * (aCov / dt) * B.transpose();
+  cov->noalias() += C * (wCov / dt) * C.transpose();
 
   // NOTE(frank): (Gi*dt)*(C/dt)*(Gi'*dt), with Gi << Z_3x3, I_3x3, Z_3x3 (9x3 matrix)
-  preintMeasCov_.block<3, 3>(3, 3).noalias() += iCov * dt;
+  cov->block<3, 3>(3, 3).noalias() += iCov * dt;
+}
+
+//------------------------------------------------------------------------------
+void PreintegratedImuMeasurements::integrateMeasurement(
+    const Vector3& measuredAcc, const Vector3& measuredOmega, double dt) {
+  if (dt <= 0) {
+    throw std::runtime_error(
+        "PreintegratedImuMeasurements::integrateMeasurement: dt <=0");
+  }
+
+  // Update preintegrated measurements (also get Jacobian)
+  Matrix9 A;  // overall Jacobian wrt preintegrated measurements (df/dx)
+  Matrix93 B, C;  // Jacobian of state wrpt accel bias and omega bias respectively.
+  PreintegrationType::update(measuredAcc, measuredOmega, dt, &A, &B, &C);
+
+  propagateCovariance(A, B, C, dt, &preintMeasCov_);
 }
 
 //------------------------------------------------------------------------------
 void PreintegratedImuMeasurements::integrateMeasurements(
-    const Matrix& measuredAccs, const Matrix& measuredOmegas,
-    const Matrix& dts) {
-  assert(
-      measuredAccs.rows() == 3 && measuredOmegas.rows() == 3 && dts.rows() == 1);
-  assert(dts.cols() >= 1);
-  assert(measuredAccs.cols() == dts.cols());
-  assert(measuredOmegas.cols() == dts.cols());
-  size_t n = static_cast<size_t>(dts.cols());
-  for (size_t j = 0; j < n; j++) {
-    integrateMeasurement(measuredAccs.col(j), measuredOmegas.col(j), dts(0, j));
+    const Matrix& measuredAccs, const Matrix& measuredOmegas, const Vector& dts) {
+  CheckMeasurements(measuredAccs, measuredOmegas, dts,
+                    "PreintegratedImuMeasurements::integrateMeasurements");
+
+  Matrix9 A;
+  Matrix93 B, C;
+  for (Eigen::Index j = 0; j < dts.size(); j++) {
+    const double dt = dts(j);
+    PreintegrationType::update(measuredAccs.col(j), measuredOmegas.col(j), dt,
+                               &A, &B, &C);
+    propagateCovariance(A, B, C, dt, &preintMeasCov_);
   }
 }
 
@@ -79,6 +79,10 @@ protected:
   Matrix9 preintMeasCov_; ///< COVARIANCE OF: [PreintROTATION PreintPOSITION PreintVELOCITY]
   ///< (first-order propagation from *measurementCovariance*).
 
+  /// First-order propagation of cov through one measurement with Jacobians A, B, C
+  void propagateCovariance(const Matrix9& A, const Matrix93& B,
+                           const Matrix93& C, double dt, Matrix9* cov) const;
+
 public:
 
   /// Default constructor for serialization and wrappers
@@ -133,9 +137,22 @@ public:
   void integrateMeasurement(const Vector3& measuredAcc,
       const Vector3& measuredOmega, const double dt) override;
 
-  /// Add multiple measurements, in matrix columns
-  void integrateMeasurements(const Matrix& measuredAccs, const Matrix& measuredOmegas,
-                             const Matrix& dts);
+  /// Add multiple measurements, in matrix columns, with dts a row or column
+  template <class DTS>
+  void integrateMeasurements(const Matrix& measuredAccs,
+                             const Matrix& measuredOmegas,
+                             const Eigen::MatrixBase<DTS>& dts) {
+    integrateMeasurements(measuredAccs, measuredOmegas, Vector(dts.reshaped()));
+  }
+
+  /**
+   * Add a buffer of measurements, in matrix columns, with time intervals dts.
+   * Equivalent to calling integrateMeasurement for each column, but updates
+   * the preintegrated state without virtual calls.
+   */
+  void integrateMeasurements(const Matrix& measuredAccs,
+                             const Matrix& measuredOmegas,
+                             const Vector& dts) override;
 
   /// Return pre-integrated measurement covariance
   Matrix preintMeasCov() const { return preintMeasCov_; }
@@ -22,6 +22,7 @@
 
 #include "PreintegrationBase.h"
 #include <gtsam/base/numericalDerivative.h>
+#include <stdexcept>
 
 using namespace std;
 
@@ -111,6 +112,29 @@ void PreintegrationBase::integrateMeasurement(const Vector3& measuredAcc,
   update(measuredAcc, measuredOmega, dt, &A, &B, &C);
 }
 
+//------------------------------------------------------------------------------
+void PreintegrationBase::CheckMeasurements(const Matrix& measuredAccs,
+    const Matrix& measuredOmegas, const Vector& dts, const string& caller) {
+  if (measuredAccs.rows() != 3 || measuredOmegas.rows() != 3 ||
+      measuredAccs.cols() != dts.size() || measuredOmegas.cols() != dts.size()) {
+    throw std::invalid_argument(
+        caller + ": expected 3*N measurements and N time intervals");
+  }
+  if ((dts.array() <= 0).any()) {
+    throw std::runtime_error(caller + ": dt <=0");
+  }
+}
+
+//------------------------------------------------------------------------------
+void PreintegrationBase::integrateMeasurements(const Matrix& measuredAccs,
+    const Matrix& measuredOmegas, const Vector& dts) {
+  CheckMeasurements(measuredAccs, measuredOmegas, dts,
+                    "PreintegrationBase::integrateMeasurements");
+  for (Eigen::Index j = 0; j < dts.size(); j++) {
+    integrateMeasurement(measuredAccs.col(j), measuredOmegas.col(j), dts(j));
+  }
+}
+
 //------------------------------------------------------------------------------
 NavState PreintegrationBase::predict(const NavState& state_i,
     const imuBias::ConstantBias& bias_i, OptionalJacobian<9, 9> H1,
@@ -145,6 +145,16 @@ class GTSAM_EXPORT PreintegrationBase {
   virtual void integrateMeasurement(const Vector3& measuredAcc,
       const Vector3& measuredOmega, const double dt);
 
+  /**
+   * Integrate a buffer of measurements, equivalent to calling
+   * integrateMeasurement for each column of measuredAccs and measuredOmegas.
+   * @param measuredAccs 3*N matrix of measured accelerations
+   * @param measuredOmegas 3*N matrix of measured angular velocities
+   * @param dts N time intervals, all positive
+   */
+  virtual void integrateMeasurements(const Matrix& measuredAccs,
+      const Matrix& measuredOmegas, const Vector& dts);
+
   /// Given the estimate of the bias, return a NavState tangent vector
   /// summarizing the preintegrated IMU measurements so far
   virtual Vector9 biasCorrectedDelta(const imuBias::ConstantBias& bias_i,
@@ -172,6 +182,13 @@ class GTSAM_EXPORT PreintegrationBase {
       OptionalJacobian<9, 6> H3 = {}, OptionalJacobian<9, 3> H4 = {}, 
       OptionalJacobian<9, 6> H5 = {}) const;
 
+  /// @}
+
+ protected:
+  /// Throw if a buffer passed to integrateMeasurements is malformed
+  static void CheckMeasurements(const Matrix& measuredAccs,
+      const Matrix& measuredOmegas, const Vector& dts, const std::string& caller);
+
  private:
 #ifdef GTSAM_ENABLE_BOOST_SERIALIZATION
   /** Serialization function */
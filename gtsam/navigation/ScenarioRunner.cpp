@@ -16,8 +16,15 @@
  */
 
 #include <gtsam/base/timing.h>
+#include <gtsam/config.h>  // for GTSAM_USE_TBB
 #include <gtsam/navigation/ScenarioRunner.h>
 
+#ifdef GTSAM_USE_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#endif
+
 #include <cmath>
 
 using namespace std;
@@ -103,6 +110,110 @@ Matrix6 ScenarioRunner::estimateNoiseCovariance(size_t N) const {
   return Q / (N - 1);
 }
 
+void ScenarioRunner::actualMeasurements(double T, Matrix* measuredAccs,
+                                        Matrix* measuredOmegas) const {
+  const double dt = imuSampleTime();
+  const size_t nrSteps = T / dt;
+  measuredAccs->resize(3, nrSteps);
+  measuredOmegas->resize(3, nrSteps);
+  double t = 0;
+  for (size_t k = 0; k < nrSteps; k++, t += dt) {
+    measuredOmegas->col(k) = actualAngularVelocity(t);
+    measuredAccs->col(k) = actualSpecificForce(t);
+  }
+}
+
+void ScenarioRunner::corruptMeasurements(std::mt19937_64* rng,
+                                         Matrix* measuredAccs,
+                                         Matrix* measuredOmegas) const {
+  // Same distributions as the samplers, scaled to discrete time
+  const Vector3 gyroSigmas = gyroSampler_.sigmas() / sqrt_dt_;
+  const Vector3 accSigmas = accSampler_.sigmas() / sqrt_dt_;
+  std::normal_distribution<double> normal;
+  for (Eigen::Index k = 0; k < measuredAccs->cols(); k++) {
+    for (int i = 0; i < 3; i++)
+      (*measuredOmegas)(i, k) +=
+          estimatedBias_.gyroscope()(i) + gyroSigmas(i) * normal(*rng);
+    for (int i = 0; i < 3; i++)
+      (*measuredAccs)(i, k) +=
+          estimatedBias_.accelerometer()(i) + accSigmas(i) * normal(*rng);
+  }
+}
+
+template <class RUNNER>
+ScenarioRunner::MonteCarloResult ScenarioRunner::MonteCarlo(
+    const RUNNER& runner, double T, size_t N, const Bias& estimatedBias,
+    uint64_t seed) {
+  gttic_(monteCarlo);
+
+  // Noise-free measurements and prediction, shared by all runs
+  Matrix actualAccs, actualOmegas;
+  runner.actualMeasurements(T, &actualAccs, &actualOmegas);
+  const Vector dts =
+      Vector::Constant(actualAccs.cols(), runner.imuSampleTime());
+  const auto expected = runner.integrate(T, estimatedBias);
+  const NavState prediction = runner.predict(runner.integrate(T));
+
+  // Each thread integrates into its own pim and measurement buffers
+  struct Workspace {
+    decltype(runner.integrate(0.0, estimatedBias)) pim;
+    Matrix measuredAccs, measuredOmegas;
+  };
+  const Workspace exemplar{runner.integrate(0.0, estimatedBias), actualAccs,
+                           actualOmegas};
+
+  // Run i draws from its own generator, so results do not depend on threads
+  Matrix samples(9, N), biases(6, N);
+  auto run = [&](size_t i, Workspace* w) {
+    std::seed_seq seq{uint32_t(seed), uint32_t(seed >> 32), uint32_t(i),
+                      uint32_t(uint64_t(i) >> 32)};
+    std::mt19937_64 rng(seq);
+    w->measuredAccs = actualAccs;
+    w->measuredOmegas = actualOmegas;
+    runner.corruptMeasurements(&rng, &w->measuredAccs, &w->measuredOmegas);
+    w->pim = exemplar.pim;
+    if (dts.size() > 0)
+      w->pim.integrateMeasurements(w->measuredAccs, w->measuredOmegas, dts);
+    samples.col(i) = runner.predict(w->pim).localCoordinates(prediction);
+    if (dts.size() > 0) {
+      biases.col(i) << (w->measuredAccs - actualAccs).rowwise().mean(),
+          (w->measuredOmegas - actualOmegas).rowwise().mean();
+    } else {
+      biases.col(i).setZero();
+    }
+  };
+
+#ifdef GTSAM_USE_TBB
+  tbb::enumerable_thread_specific<Workspace> workspaces(exemplar);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, N),
+                    [&](const tbb::blocked_range<size_t>& range) {
+                      Workspace& w = workspaces.local();
+                      for (size_t i = range.begin(); i != range.end(); ++i)
+                        run(i, &w);
+                    });
+#else
+  Workspace w = exemplar;
+  for (size_t i = 0; i < N; i++) run(i, &w);
+#endif
+
+  // Compute MC statistics
+  MonteCarloResult result;
+  result.N = N;
+  result.mean = samples.rowwise().mean();
+  const Matrix centered = samples.colwise() - result.mean;
+  result.covariance = centered * centered.transpose() / (N - 1);
+  result.predictedCovariance = expected.preintMeasCov().topLeftCorner(9, 9);
+  result.biasMean = biases.rowwise().mean();
+  const Matrix biasCentered = biases.colwise() - result.biasMean;
+  result.biasCovariance = biasCentered * biasCentered.transpose() / (N - 1);
+  return result;
+}
+
+ScenarioRunner::MonteCarloResult ScenarioRunner::monteCarlo(
+    double T, size_t N, const Bias& estimatedBias, uint64_t seed) const {
+  return MonteCarlo(*this, T, N, estimatedBias, seed);
+}
+
 PreintegratedCombinedMeasurements CombinedScenarioRunner::integrate(
     double T, const Bias& estimatedBias, bool corrupted) const {
   gttic_(integrate);
@@ -161,4 +272,9 @@ Eigen::Matrix<double, 15, 15> CombinedScenarioRunner::estimateCovariance(
   return Q / (N - 1);
 }
 
+CombinedScenarioRunner::MonteCarloResult CombinedScenarioRunner::monteCarlo(
+    double T, size_t N, const Bias& estimatedBias, uint64_t seed) const {
+  return MonteCarlo(*this, T, N, estimatedBias, seed);
+}
+
 }  // namespace gtsam
@@ -21,6 +21,9 @@
 #include <gtsam/navigation/ImuFactor.h>
 #include <gtsam/navigation/Scenario.h>
 
+#include <cstdint>
+#include <random>
+
 namespace gtsam {
 
 // Convert covariance to diagonal noise model, if possible, otherwise throw
@@ -42,6 +45,17 @@ class GTSAM_EXPORT ScenarioRunner {
   typedef imuBias::ConstantBias Bias;
   typedef std::shared_ptr<PreintegrationParams> SharedParams;
 
+  /// Statistics of N noisy integrations, as returned by monteCarlo
+  struct MonteCarloResult {
+    size_t N;                     ///< number of noisy integrations
+    Vector9 mean;                 ///< mean prediction error
+    Matrix9 covariance;           ///< sample covariance of the prediction error
+    Matrix9 predictedCovariance;  ///< covariance predicted by the noise model
+    Vector6 biasMean;             ///< mean of the per-run measurement bias
+    Matrix6 biasCovariance;       ///< sample covariance of the per-run bias
+    GTSAM_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
  private:
   const Scenario& scenario_;
   const SharedParams p_;
@@ -105,6 +119,31 @@ class GTSAM_EXPORT ScenarioRunner {
 
   /// Estimate covariance of sampled noise for sanity-check
   Matrix6 estimateNoiseCovariance(size_t N = 1000) const;
+
+  /**
+   * Parallel Monte Carlo estimate of the prediction error statistics.
+   * Like estimateCovariance, but the N noisy integrations run in parallel
+   * (with TBB), each drawing its noise from its own random generator seeded
+   * with (seed, i), so the result only depends on the seed. The per-run bias
+   * is the mean of the measurement errors over the run, as [acc; gyro].
+   */
+  MonteCarloResult monteCarlo(double T, size_t N = 1000,
+                              const Bias& estimatedBias = Bias(),
+                              uint64_t seed = 42u) const;
+
+ protected:
+  /// Noise-free measurements for T seconds, one per column
+  void actualMeasurements(double T, Matrix* measuredAccs,
+                          Matrix* measuredOmegas) const;
+
+  /// Add the bias and white noise drawn from rng to measurements
+  void corruptMeasurements(std::mt19937_64* rng, Matrix* measuredAccs,
+                           Matrix* measuredOmegas) const;
+
+  /// Run the Monte Carlo integrations for either kind of runner
+  template <class RUNNER>
+  static MonteCarloResult MonteCarlo(const RUNNER& runner, double T, size_t N,
+                                     const Bias& estimatedBias, uint64_t seed);
 };
 
 /*
@@ -144,6 +183,11 @@ class GTSAM_EXPORT CombinedScenarioRunner : public ScenarioRunner {
   /// Compute a Monte Carlo estimate of the predict covariance using N samples
   Eigen::Matrix<double, 15, 15> estimateCovariance(
       double T, size_t N = 1000, const Bias& estimatedBias = Bias()) const;
+
+  /// Parallel Monte Carlo estimate, see ScenarioRunner::monteCarlo
+  MonteCarloResult monteCarlo(double T, size_t N = 1000,
+                              const Bias& estimatedBias = Bias(),
+                              uint64_t seed = 42u) const;
 };
 
 }  // namespace gtsam
@@ -120,6 +120,8 @@ class PreintegratedImuMeasurements {
   // Standard Interface
   void integrateMeasurement(Vector measuredAcc, Vector measuredOmega,
       double deltaT);
+  void integrateMeasurements(Matrix measuredAccs, Matrix measuredOmegas,
+      Vector dts);
   void resetIntegration();
   void resetIntegrationAndSetBias(const gtsam::imuBias::ConstantBias& biasHat);
 
@@ -186,6 +188,8 @@ class PreintegratedCombinedMeasurements {
   // Standard Interface
   void integrateMeasurement(Vector measuredAcc, Vector measuredOmega,
       double deltaT);
+  void integrateMeasurements(Matrix measuredAccs, Matrix measuredOmegas,
+      Vector dts);
   void resetIntegration();
   void resetIntegrationAndSetBias(const gtsam::imuBias::ConstantBias& biasHat);
 
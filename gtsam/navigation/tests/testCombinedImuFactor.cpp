@@ -320,6 +320,44 @@ TEST(CombinedImuFactor, Accelerating) {
   EXPECT(assert_equal(estimatedCov, expected, 0.1));
 }
 
+/* ************************************************************************* */
+TEST(CombinedImuFactor, IntegrateMeasurementBuffer) {
+  auto p = testing::Params(1e-4 * I_3x3, 1e-5 * I_3x3, 1e-3 * I_6x6);
+  const Bias biasHat(Vector3(0.01, 0.02, 0.03), Vector3(0.001, 0.002, 0.003));
+
+  const int n = 50;
+  Matrix acc(3, n), gyro(3, n);
+  Vector dts(n);
+  PreintegratedCombinedMeasurements expected(p, biasHat);
+  for (int j = 0; j < n; j++) {
+    acc.col(j) << 0.1 + 0.01 * j, -0.2, 9.81 + 0.05 * std::sin(0.3 * j);
+    gyro.col(j) << 0.02 * std::cos(0.1 * j), 0.01, -0.03;
+    dts(j) = 0.005 + 0.0001 * (j % 3);
+    expected.integrateMeasurement(acc.col(j), gyro.col(j), dts(j));
+  }
+
+  PreintegratedCombinedMeasurements actual(p, biasHat);
+  actual.integrateMeasurements(acc, gyro, dts);
+  EXPECT(assert_equal(expected, actual, 1e-9));
+}
+
+/* ************************************************************************* */
+TEST(CombinedImuFactor, MonteCarlo) {
+  const AcceleratingScenario scenario(Rot3(), Point3(10, 20, 0),
+                                      Vector3(50, 0, 0), Vector3(0.2, 0, 0));
+  const double T = 3.0;  // seconds
+  CombinedScenarioRunner runner(scenario, testing::Params(), T / 10);
+
+  const auto result = runner.monteCarlo(T, 100);
+  const Eigen::Matrix<double, 15, 15> expected =
+      runner.integrate(T).preintMeasCov();
+  EXPECT(assert_equal(Matrix9(expected.topLeftCorner<9, 9>()),
+                      result.predictedCovariance));
+  const Matrix9 estimated =
+      runner.estimateCovariance(T, 100).topLeftCorner<9, 9>();
+  EXPECT(assert_equal(result.covariance, estimated, 0.1));
+}
+
 /* ************************************************************************* */
 TEST(CombinedImuFactor, ResetIntegration) {
   const double a = 0.2, v = 50;
@@ -239,6 +239,47 @@ TEST(ImuFactor, MultipleMeasurements) {
   EXPECT(assert_equal(expected,actual));
 }
 
+/* ************************************************************************* */
+TEST(ImuFactor, IntegrateMeasurementBuffer) {
+  auto p = testing::Params();
+  p->body_P_sensor = Pose3(Rot3::Ypr(0.1, 0.2, 0.3), Point3(0.1, 0.05, 0.01));
+  const Bias biasHat(Vector3(0.01, 0.02, 0.03), Vector3(0.001, 0.002, 0.003));
+
+  // A buffer of varying samples, integrated one at a time as reference
+  const int n = 50;
+  Matrix acc(3, n), gyro(3, n);
+  Vector dts(n);
+  PreintegratedImuMeasurements expected(p, biasHat);
+  for (int j = 0; j < n; j++) {
+    acc.col(j) << 0.1 + 0.01 * j, -0.2, 9.81 + 0.05 * std::sin(0.3 * j);
+    gyro.col(j) << 0.02 * std::cos(0.1 * j), 0.01, -0.03;
+    dts(j) = 0.005 + 0.0001 * (j % 3);
+    expected.integrateMeasurement(acc.col(j), gyro.col(j), dts(j));
+  }
+
+  PreintegratedImuMeasurements actual(p, biasHat);
+  actual.integrateMeasurements(acc, gyro, dts);
+  EXPECT(assert_equal(expected, actual, 1e-9));
+
+  // Through the base class, and continuing a partial integration
+  PreintegratedImuMeasurements split(p, biasHat);
+  split.integrateMeasurements(acc.leftCols(20), gyro.leftCols(20), dts.head(20));
+  PreintegrationType& base = split;
+  base.integrateMeasurements(acc.rightCols(n - 20), gyro.rightCols(n - 20),
+                             Vector(dts.tail(n - 20)));
+  EXPECT(assert_equal(expected, split, 1e-9));
+
+  // Malformed buffers are rejected before integrating anything
+  PreintegratedImuMeasurements rejected(p, biasHat);
+  CHECK_EXCEPTION(rejected.integrateMeasurements(acc, gyro, dts.head(n - 1)),
+                  std::invalid_argument);
+  Vector badDts = dts;
+  badDts(n - 1) = 0;
+  CHECK_EXCEPTION(rejected.integrateMeasurements(acc, gyro, badDts),
+                  std::runtime_error);
+  EXPECT_DOUBLES_EQUAL(0, rejected.deltaTij(), 0);
+}
+
 /* ************************************************************************* */
 TEST(ImuFactor, ErrorAndJacobians) {
   using namespace common;
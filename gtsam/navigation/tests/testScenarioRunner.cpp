@@ -19,9 +19,14 @@
 
 #include <gtsam/navigation/ScenarioRunner.h>
 #include <gtsam/base/timing.h>
+#include <gtsam/config.h>  // for GTSAM_USE_TBB
 #include <CppUnitLite/TestHarness.h>
 #include <cmath>
 
+#ifdef GTSAM_USE_TBB
+#include <tbb/global_control.h>
+#endif
+
 using namespace std;
 using namespace gtsam;
 
@@ -186,6 +191,45 @@ TEST(ScenarioRunner, AcceleratingWithBias) {
   EXPECT(assert_equal(estimatedCov, pim.preintMeasCov(), 0.1));
 }
 
+/* ************************************************************************* */
+TEST(ScenarioRunner, MonteCarlo) {
+  gttic(MonteCarlo);
+  using namespace accelerating;
+  ScenarioRunner runner(scenario, defaultParams(), T / 10, kNonZeroBias);
+
+  const size_t N = 1000;
+  const auto result = runner.monteCarlo(T, N, kNonZeroBias);
+  EXPECT_LONGS_EQUAL(N, result.N);
+
+  // Same prediction error statistics as the serial estimate
+  auto pim = runner.integrate(T, kNonZeroBias);
+  EXPECT(assert_equal(Matrix9(pim.preintMeasCov()), result.predictedCovariance));
+  EXPECT(assert_equal(result.covariance, pim.preintMeasCov(), 0.1));
+  EXPECT(assert_equal(result.covariance,
+                      runner.estimateCovariance(T, 100, kNonZeroBias), 0.1));
+
+  // The bias seen by each run is the true bias plus the mean of its noise
+  EXPECT_NEAR(result.biasMean, kNonZeroBias.vector(), 1e-3);
+  Vector6 expectedBiasVariance;
+  expectedBiasVariance << Vector3::Constant(kAccelSigma * kAccelSigma / T),
+      Vector3::Constant(kGyroSigma * kGyroSigma / T);
+  const Vector6 ratio =
+      result.biasCovariance.diagonal().cwiseQuotient(expectedBiasVariance);
+  EXPECT_NEAR(ratio, Vector6::Ones(), 0.2);
+
+  // Reproducible for a given seed, independent of the number of threads
+  const auto again = [&]() {
+#ifdef GTSAM_USE_TBB
+    tbb::global_control serial(tbb::global_control::max_allowed_parallelism, 1);
+#endif
+    return runner.monteCarlo(T, N, kNonZeroBias);
+  }();
+  EXPECT(assert_equal(result.covariance, again.covariance, 0));
+  EXPECT(assert_equal(result.biasCovariance, again.biasCovariance, 0));
+  const auto other = runner.monteCarlo(T, N, kNonZeroBias, 7);
+  EXPECT(result.biasMean != other.biasMean);
+}
+
 /* ************************************************************************* */
 TEST(ScenarioRunner, AcceleratingAndRotating) {
   gttic(AcceleratingAndRotating);
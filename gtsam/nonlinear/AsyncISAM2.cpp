@@ -0,0 +1,122 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    AsyncISAM2.cpp
+ * @brief   ISAM2 running its updates on a worker thread
+ */
+
+#include <gtsam/nonlinear/AsyncISAM2.h>
+
+#include <utility>
+
+namespace gtsam {
+
+/* ************************************************************************* */
+AsyncISAM2::AsyncISAM2(const ISAM2Params& params)
+    : isam_(params), snapshot_(std::make_shared<Snapshot>()) {
+  worker_ = std::thread([this] { run(); });
+}
+
+/* ************************************************************************* */
+AsyncISAM2::~AsyncISAM2() {
+  {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    stop_ = true;
+  }
+  queueChanged_.notify_all();
+  worker_.join();
+}
+
+/* ************************************************************************* */
+void AsyncISAM2::update(const NonlinearFactorGraph& newFactors,
+                        const Values& newTheta,
+                        const ISAM2UpdateParams& updateParams) {
+  {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    rethrowError();
+    queue_.push_back(QueuedUpdate{newFactors, newTheta, updateParams});
+  }
+  queueChanged_.notify_all();
+}
+
+/* ************************************************************************* */
+std::shared_ptr<const AsyncISAM2::Snapshot> AsyncISAM2::snapshot() const {
+  std::lock_guard<std::mutex> lock(snapshotMutex_);
+  return snapshot_;
+}
+
+/* ************************************************************************* */
+size_t AsyncISAM2::updatesPending() const {
+  std::lock_guard<std::mutex> lock(queueMutex_);
+  return queue_.size();
+}
+
+/* ************************************************************************* */
+void AsyncISAM2::waitUntilIdle() {
+  std::unique_lock<std::mutex> lock(queueMutex_);
+  queueChanged_.wait(lock, [this] { return queue_.empty(); });
+  rethrowError();
+}
+
+/* ************************************************************************* */
+const ISAM2& AsyncISAM2::isam2() {
+  waitUntilIdle();
+  return isam_;
+}
+
+/* ************************************************************************* */
+void AsyncISAM2::rethrowError() {
+  if (error_) {
+    std::exception_ptr error;
+    std::swap(error, error_);
+    std::rethrow_exception(error);
+  }
+}
+
+/* ************************************************************************* */
+void AsyncISAM2::run() {
+  std::unique_lock<std::mutex> lock(queueMutex_);
+  while (true) {
+    queueChanged_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) return;  // stopped, and all updates are completed
+
+    // The front stays in the queue while it is processed, so that it counts
+    // as pending. Pushing to a deque does not invalidate references to it.
+    const QueuedUpdate& next = queue_.front();
+    lock.unlock();
+
+    std::exception_ptr error;
+    try {
+      auto snapshot = std::make_shared<Snapshot>();
+      snapshot->result =
+          isam_.update(next.newFactors, next.newTheta, next.updateParams);
+      snapshot->estimate = isam_.calculateEstimate();
+
+      std::lock_guard<std::mutex> snapshotLock(snapshotMutex_);
+      snapshot->updates = snapshot_->updates + 1;
+      snapshot_ = std::move(snapshot);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    lock.lock();
+    queue_.pop_front();
+    if (error) {
+      // Later updates may depend on the failed one, drop them
+      if (!error_) error_ = error;
+      queue_.clear();
+    }
+    queueChanged_.notify_all();
+  }
+}
+
+}  // namespace gtsam
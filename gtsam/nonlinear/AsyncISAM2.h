@@ -0,0 +1,142 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    AsyncISAM2.h
+ * @brief   ISAM2 running its updates on a worker thread
+ */
+
+// \callgraph
+
+#pragma once
+
+#include <gtsam/nonlinear/ISAM2.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace gtsam {
+
+/**
+ * @ingroup isam2
+ * Runs ISAM2 on a worker thread, so that the caller never waits for
+ * relinearization and re-elimination.
+ *
+ * update() only queues the new factors and values and returns immediately. The
+ * worker applies the queued updates in order to its own ISAM2 instance, and
+ * after each one publishes the estimate of the completed Bayes tree by
+ * swapping a shared pointer. Queries are answered from the last published
+ * estimate, so they never wait for an update in progress. Once the queue is
+ * drained, the estimate is the same as that of a synchronous ISAM2 given the
+ * same sequence of updates.
+ *
+ * Factor indices in ISAM2UpdateParams::removeFactorIndices must refer to
+ * factors of completed updates, as reported in lastResult(). Call
+ * waitUntilIdle() first if they come from an update that might be pending.
+ */
+class GTSAM_EXPORT AsyncISAM2 {
+ public:
+  /// The state published after each completed update
+  struct Snapshot {
+    Values estimate;     ///< ISAM2::calculateEstimate() after the update
+    ISAM2Result result;  ///< The result returned by ISAM2::update()
+    size_t updates = 0;  ///< Number of updates completed
+  };
+
+ private:
+  /// One queued call to update()
+  struct QueuedUpdate {
+    NonlinearFactorGraph newFactors;
+    Values newTheta;
+    ISAM2UpdateParams updateParams;
+  };
+
+  ISAM2 isam_;  ///< Only accessed by the worker while it is running
+
+  /// Queue of pending updates, the front one is being processed
+  std::deque<QueuedUpdate> queue_;
+  bool stop_ = false;
+  std::exception_ptr error_;  ///< First exception thrown by the worker
+  mutable std::mutex queueMutex_;
+  std::condition_variable queueChanged_;
+
+  /// Last published state, swapped under its own mutex so that queries never
+  /// wait for the queue
+  std::shared_ptr<const Snapshot> snapshot_;
+  mutable std::mutex snapshotMutex_;
+
+  std::thread worker_;
+
+ public:
+  /// Create an empty ISAM2 and start the worker thread
+  explicit AsyncISAM2(const ISAM2Params& params = ISAM2Params());
+
+  /// Complete all queued updates and stop the worker thread
+  ~AsyncISAM2();
+
+  AsyncISAM2(const AsyncISAM2&) = delete;
+  AsyncISAM2& operator=(const AsyncISAM2&) = delete;
+
+  /**
+   * Queue an update, see ISAM2::update(). Returns immediately. Rethrows, once,
+   * an exception thrown by an earlier update, in which case all updates that
+   * were still queued at that time have been dropped.
+   */
+  void update(const NonlinearFactorGraph& newFactors = NonlinearFactorGraph(),
+              const Values& newTheta = Values(),
+              const ISAM2UpdateParams& updateParams = ISAM2UpdateParams());
+
+  /// The state after the last completed update, never null
+  std::shared_ptr<const Snapshot> snapshot() const;
+
+  /// Estimate after the last completed update
+  Values calculateEstimate() const { return snapshot()->estimate; }
+
+  /// Estimate of a single variable after the last completed update
+  template <class VALUE>
+  VALUE calculateEstimate(Key key) const {
+    return snapshot()->estimate.at<VALUE>(key);
+  }
+
+  /// Result of the last completed update
+  ISAM2Result lastResult() const { return snapshot()->result; }
+
+  /// Number of updates completed so far
+  size_t updatesCompleted() const { return snapshot()->updates; }
+
+  /// Number of queued updates not completed yet, including a running one
+  size_t updatesPending() const;
+
+  /**
+   * Block until all queued updates are completed. Rethrows, once, an
+   * exception thrown by one of them.
+   */
+  void waitUntilIdle();
+
+  /**
+   * Access the underlying ISAM2 after waiting for all queued updates, e.g. to
+   * compute marginals. Must not be used concurrently with update().
+   */
+  const ISAM2& isam2();
+
+ private:
+  /// Main loop of the worker thread
+  void run();
+
+  /// Rethrow and clear error_, requires queueMutex_ to be locked
+  void rethrowError();
+};
+
+}  // namespace gtsam
@@ -19,9 +19,14 @@
 
 #include <gtsam/nonlinear/BatchFixedLagSmoother.h>
 #include <gtsam/nonlinear/LinearContainerFactor.h>
+#include <gtsam/linear/GaussianBayesNet.h>
 #include <gtsam/linear/GaussianJunctionTree.h>
 #include <gtsam/linear/GaussianFactorGraph.h>
 #include <gtsam/linear/GaussianFactor.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/inference/VariableIndex.h>
+
+#include <algorithm>
 
 using namespace std;
 
@@ -54,13 +59,20 @@ FixedLagSmoother::Result BatchFixedLagSmoother::update(
     const NonlinearFactorGraph& newFactors, const Values& newTheta,
     const KeyTimestampMap& timestamps, const FactorIndices& factorsToRemove) {
 
+  // Take eliminated factors out of the Bayes net before they are removed
+  if (incremental_) removeEliminatedFactors(factorsToRemove);
+
   // Update all of the internal variables with the new information
   gttic(augment_system);
   // Add the new variables to theta
   theta_.insert(newTheta);
   // Add new variables to the end of the ordering
-  for (const auto key : newTheta.keys()) {
-    ordering_.push_back(key);
+  if (incremental_) {
+    for (const auto key : newTheta.keys()) activeKeys_.insert(key);
+  } else {
+    for (const auto key : newTheta.keys()) {
+      ordering_.push_back(key);
+    }
   }
   // Augment Delta
   delta_.insert(newTheta.zeroVectors());
@@ -73,6 +85,7 @@ FixedLagSmoother::Result BatchFixedLagSmoother::update(
   for(const size_t i : factorsToRemove){
     if(factors_[i])
       factors_[i].reset();
+    activeSlots_.erase(i);
   }
 
   // Update the Timestamps associated with the factor keys
@@ -85,6 +98,9 @@ FixedLagSmoother::Result BatchFixedLagSmoother::update(
   KeyVector marginalizableKeys = findKeysBefore(
       current_timestamp - smootherLag_);
 
+  if (incremental_)
+    return updateIncremental(newFactors, newTheta, marginalizableKeys);
+
   // Reorder
   gttic(reorder);
   reorder(marginalizableKeys);
@@ -122,6 +138,7 @@ void BatchFixedLagSmoother::insertFactors(
       index = factors_.size();
       factors_.push_back(factor);
     }
+    if (incremental_) activeSlots_.insert(index);
     // Update the FactorIndex
     for(Key key: *factor) {
       factorIndex_[key].insert(index);
@@ -140,6 +157,7 @@ void BatchFixedLagSmoother::removeFactors(
       }
       // Remove the factor from the factor graph
       factors_.remove(slot);
+      activeSlots_.erase(slot);
       // Add the factor's old slot to the list of available slots
       availableSlots_.push(slot);
     } else {
@@ -168,9 +186,11 @@ void BatchFixedLagSmoother::eraseKeys(const KeyVector& keys) {
 
   eraseKeyTimestampMap(keys);
 
-  // Remove marginalized keys from the ordering and delta
+  // Remove marginalized keys from the ordering and delta. In incremental mode
+  // the ordering is assembled by getOrdering().
   for(Key key: keys) {
-    ordering_.erase(find(ordering_.begin(), ordering_.end(), key));
+    if (!incremental_)
+      ordering_.erase(find(ordering_.begin(), ordering_.end(), key));
     delta_.erase(key);
   }
 }
@@ -183,10 +203,18 @@ void BatchFixedLagSmoother::reorder(const KeyVector& marginalizeKeys) {
 
 /* ************************************************************************* */
 FixedLagSmoother::Result BatchFixedLagSmoother::optimize() {
+  return optimize(factors_, GaussianFactorGraph(), ordering_, &theta_, &delta_);
+}
+
+/* ************************************************************************* */
+FixedLagSmoother::Result BatchFixedLagSmoother::optimize(
+    const NonlinearFactorGraph& factors,
+    const GaussianFactorGraph& linearFactors, const Ordering& ordering,
+    Values* theta, VectorValues* delta) {
 
   // Create output result structure
   Result result;
-  result.nonlinearVariables = theta_.size() - linearValues_.size();
+  result.nonlinearVariables = theta->size() - linearValues_.size();
   result.linearVariables = linearValues_.size();
 
   // Set optimization parameters
@@ -200,8 +228,8 @@ FixedLagSmoother::Result BatchFixedLagSmoother::optimize() {
   double errorTol = parameters_.errorTol;
 
   // Create a Values that holds the current evaluation point
-  Values evalpoint = theta_.retract(delta_);
-  result.error = factors_.error(evalpoint);
+  Values evalpoint = theta->retract(*delta);
+  result.error = factors.error(evalpoint) + linearFactors.error(*delta);
 
   // check if we're already close enough
   if (result.error <= errorTol) {
@@ -218,7 +246,8 @@ FixedLagSmoother::Result BatchFixedLagSmoother::optimize() {
     gttic(optimizer_iteration);
     {
       // Linearize graph around the linearization point
-      GaussianFactorGraph linearFactorGraph = *factors_.linearize(theta_);
+      GaussianFactorGraph linearFactorGraph = *factors.linearize(*theta);
+      linearFactorGraph.push_back(linearFactors);
 
       // Keep increasing lambda until we make make progress
       while (true) {
@@ -226,11 +255,11 @@ FixedLagSmoother::Result BatchFixedLagSmoother::optimize() {
         // Add prior factors at the current solution
         gttic(damp);
         GaussianFactorGraph dampedFactorGraph(linearFactorGraph);
-        dampedFactorGraph.reserve(linearFactorGraph.size() + delta_.size());
+        dampedFactorGraph.reserve(linearFactorGraph.size() + delta->size());
         {
           // for each of the variables, add a prior at the current solution
           double sigma = 1.0 / sqrt(lambda);
-          for(const auto& key_value: delta_) {
+          for(const auto& key_value: *delta) {
             size_t dim = key_value.second.size();
             Matrix A = Matrix::Identity(dim, dim);
             Vector b = key_value.second;
@@ -245,15 +274,15 @@ FixedLagSmoother::Result BatchFixedLagSmoother::optimize() {
 
         gttic(solve);
         // Solve Damped Gaussian Factor Graph
-        newDelta = dampedFactorGraph.optimize(ordering_,
+        newDelta = dampedFactorGraph.optimize(ordering,
             parameters_.getEliminationFunction());
         // update the evalpoint with the new delta
-        evalpoint = theta_.retract(newDelta);
+        evalpoint = theta->retract(newDelta);
         gttoc(solve);
 
         // Evaluate the new error
         gttic(compute_error);
-        double error = factors_.error(evalpoint);
+        double error = factors.error(evalpoint) + linearFactors.error(newDelta);
         gttoc(compute_error);
 
         if (error < result.error) {
@@ -261,14 +290,15 @@ FixedLagSmoother::Result BatchFixedLagSmoother::optimize() {
           // Update the error value
           result.error = error;
           // Update the linearization point
-          theta_ = evalpoint;
+          *theta = evalpoint;
           // Reset the deltas to zeros
-          delta_.setZero();
-          // Put the linearization points and deltas back for specific variables
-          if (enforceConsistency_ && (linearValues_.size() > 0)) {
-            theta_.update(linearValues_);
+          delta->setZero();
+          // Put the linearization points and deltas back for specific variables,
+          // which the linear factors of incremental mode always require
+          if ((enforceConsistency_ || incremental_) && (linearValues_.size() > 0)) {
+            theta->update(linearValues_);
             for(const auto key: linearValues_.keys()) {
-              delta_.at(key) = newDelta.at(key);
+              delta->at(key) = newDelta.at(key);
             }
           }
           // Decrease lambda for next time
@@ -344,6 +374,319 @@ void BatchFixedLagSmoother::marginalize(const KeyVector& marginalizeKeys) {
   insertFactors(marginalFactors);
 }
 
+/* ************************************************************************* */
+const Ordering& BatchFixedLagSmoother::getOrdering() const {
+  if (incremental_) {
+    ordering_ = Ordering();
+    for (const auto& conditional : conditionals_)
+      ordering_.push_back(conditional->firstFrontalKey());
+    ordering_.insert(ordering_.end(), activeOrdering_.begin(),
+                     activeOrdering_.end());
+  }
+  return ordering_;
+}
+
+/* ************************************************************************* */
+FixedLagSmoother::Result BatchFixedLagSmoother::updateIncremental(
+    const NonlinearFactorGraph& newFactors, const Values& newTheta,
+    const KeyVector& marginalizableKeys) {
+
+  // New factors on eliminated variables make them active again
+  gttic(reactivate);
+  KeySet involvedKeys = newFactors.keys();
+  for (const auto key : newTheta.keys()) involvedKeys.insert(key);
+  KeySet reactivatedKeys;
+  for (Key key : involvedKeys) {
+    if (eliminatedKeys_.count(key)) reactivatedKeys.insert(key);
+  }
+  if (!reactivatedKeys.empty()) reactivate(reactivatedKeys);
+  gttoc(reactivate);
+
+  // Eliminate the active variables left behind by the new factors, and those
+  // about to be marginalized, oldest first
+  gttic(eliminate);
+  const size_t firstNew = firstPosition_ + conditionals_.size();
+  const KeySet marginalizableSet(marginalizableKeys.begin(),
+                                 marginalizableKeys.end());
+  vector<pair<pair<bool, double>, Key>> eliminateKeys;
+  for (const auto key : activeKeys_) {
+    const bool marginalizable = marginalizableSet.count(key) > 0;
+    if (marginalizable || !involvedKeys.count(key)) {
+      const auto timestamp = keyTimestampMap_.find(key);
+      eliminateKeys.push_back(
+          {{!marginalizable, timestamp == keyTimestampMap_.end()
+                                 ? 0.0
+                                 : timestamp->second},
+           key});
+    }
+  }
+  sort(eliminateKeys.begin(), eliminateKeys.end());
+  KeyVector eliminateOrder;
+  for (const auto& entry : eliminateKeys) eliminateOrder.push_back(entry.second);
+  eliminate(eliminateOrder);
+  gttoc(eliminate);
+
+  // Optimize the active variables, holding those of the separator factors at
+  // their linearization point
+  gttic(optimize);
+  NonlinearFactorGraph activeFactors;
+  for (size_t slot : activeSlots_) {
+    if (factors_[slot]) activeFactors.push_back(factors_[slot]);
+  }
+  Values activeTheta;
+  VectorValues activeDelta;
+  for (const auto key : activeKeys_) {
+    activeTheta.insert(key, theta_.at(key));
+    activeDelta.insert(key, delta_.at(key));
+  }
+  linearValues_.clear();
+  for (Key key : separatorFactors_.keys())
+    linearValues_.insert(key, theta_.at(key));
+
+  VariableIndex variableIndex(activeFactors);
+  variableIndex.augment(separatorFactors_);
+  activeOrdering_ = Ordering::Colamd(variableIndex);
+  for (const auto key : activeTheta.keys()) {
+    if (variableIndex.find(key) == variableIndex.end())
+      activeOrdering_.push_back(key);
+  }
+
+  Result result;
+  if (!activeTheta.empty()) {
+    result = optimize(activeFactors, separatorFactors_, activeOrdering_,
+                      &activeTheta, &activeDelta);
+    theta_.update(activeTheta);
+  }
+  gttoc(optimize);
+
+  // Back-substitute into the eliminated variables
+  gttic(backsubstitute);
+  backSubstitute(activeDelta, firstNew);
+  gttoc(backsubstitute);
+
+  gttic(marginalize);
+  if (marginalizableKeys.size() > 0) {
+    marginalizeEliminated(marginalizableKeys);
+  }
+  gttoc(marginalize);
+
+  return result;
+}
+
+/* ************************************************************************* */
+void BatchFixedLagSmoother::backSubstitute(const VectorValues& activeDelta,
+                                           size_t firstNew) {
+  // Conditionals to solve, by position in the elimination order. Parents are
+  // eliminated after their children, so solving from the last position down
+  // solves every parent before the conditionals that depend on it.
+  set<size_t> pending;
+  auto addDependents = [&](Key key) {
+    const auto dependents = dependents_.find(key);
+    if (dependents == dependents_.end()) return;
+    for (Key dependent : dependents->second)
+      pending.insert(eliminatedKeys_.at(dependent));
+  };
+  auto changed = [this](const Vector& newValue, const Vector& oldValue) {
+    return (newValue - oldValue).lpNorm<Eigen::Infinity>() > wildfireThreshold_;
+  };
+
+  for (const auto& [key, value] : activeDelta) {
+    Vector& oldValue = delta_.at(key);
+    if (changed(value, oldValue)) addDependents(key);
+    oldValue = value;
+  }
+  for (size_t position = firstNew;
+       position < firstPosition_ + conditionals_.size(); ++position)
+    pending.insert(position);
+
+  while (!pending.empty()) {
+    const auto last = prev(pending.end());
+    const size_t position = *last;
+    pending.erase(last);
+    const auto& conditional = conditionals_[position - firstPosition_];
+    const Key key = conditional->firstFrontalKey();
+    const VectorValues solution = conditional->solve(delta_);
+    Vector& oldValue = delta_.at(key);
+    if (position >= firstNew || changed(solution.at(key), oldValue)) {
+      oldValue = solution.at(key);
+      addDependents(key);
+    }
+  }
+}
+
+/* ************************************************************************* */
+void BatchFixedLagSmoother::pushConditional(
+    const GaussianConditional::shared_ptr& conditional) {
+  const Key key = conditional->firstFrontalKey();
+  eliminatedKeys_[key] = firstPosition_ + conditionals_.size();
+  activeKeys_.erase(key);
+  for (Key parent : conditional->parents()) dependents_[parent].push_back(key);
+  conditionals_.push_back(conditional);
+}
+
+/* ************************************************************************* */
+void BatchFixedLagSmoother::forgetConditional(
+    const GaussianConditional::shared_ptr& conditional) {
+  const Key key = conditional->firstFrontalKey();
+  eliminatedKeys_.erase(key);
+  for (Key parent : conditional->parents()) {
+    const auto dependents = dependents_.find(parent);
+    if (dependents == dependents_.end()) continue;
+    KeyVector& keys = dependents->second;
+    keys.erase(std::remove(keys.begin(), keys.end(), key), keys.end());
+    if (keys.empty()) dependents_.erase(dependents);
+  }
+}
+
+/* ************************************************************************* */
+void BatchFixedLagSmoother::removeEliminatedFactors(
+    const FactorIndices& factorsToRemove) {
+  // The information of an eliminated factor is in the conditionals from the
+  // first one on its variables onwards, and in the separator factors.
+  // Reactivating those conditionals, as for a new factor on the variables,
+  // leaves the information of all earlier conditionals summarized in linear
+  // factors on variables that include all of the factor's.
+  KeySet keys;
+  vector<size_t> slots;
+  for (const size_t i : factorsToRemove) {
+    if (!eliminatedSlots_.count(i) || !factors_[i]) continue;
+    slots.push_back(i);
+    for (Key key : *factors_[i]) {
+      if (eliminatedKeys_.count(key)) keys.insert(key);
+    }
+  }
+  if (!keys.empty()) reactivate(keys);
+
+  // Subtract the factor's information from those linear factors. Its
+  // variables are held at the linearization point it was eliminated at, so
+  // linearizing it again gives the same linear factor.
+  for (const size_t i : slots) {
+    const GaussianFactor::shared_ptr linear = factors_[i]->linearize(theta_);
+    vector<DenseIndex> dims;
+    for (auto key = linear->begin(); key != linear->end(); ++key)
+      dims.push_back(linear->getDim(key));
+    separatorFactors_.emplace_shared<HessianFactor>(
+        linear->keys(),
+        SymmetricBlockMatrix(dims, Matrix(-linear->augmentedInformation()),
+                             true));
+    eliminatedSlots_.erase(i);
+  }
+}
+
+/* ************************************************************************* */
+void BatchFixedLagSmoother::reactivate(const KeySet& keys) {
+  // Conditionals only depend on variables eliminated after them, so the ones
+  // before the first reactivated variable remain valid conditionals
+  size_t first = conditionals_.size();
+  for (Key key : keys) {
+    const auto eliminated = eliminatedKeys_.find(key);
+    if (eliminated != eliminatedKeys_.end())
+      first = min(first, eliminated->second - firstPosition_);
+  }
+  for (size_t i = first; i < conditionals_.size(); ++i) {
+    separatorFactors_.push_back(conditionals_[i]);
+    forgetConditional(conditionals_[i]);
+    activeKeys_.insert(conditionals_[i]->firstFrontalKey());
+  }
+  conditionals_.erase(conditionals_.begin() + first, conditionals_.end());
+}
+
+/* ************************************************************************* */
+void BatchFixedLagSmoother::eliminate(const KeyVector& keys) {
+  const KeySet keySet(keys.begin(), keys.end());
+
+  // Gather the separator factors and the active factors on the keys
+  GaussianFactorGraph graph, remaining;
+  for (const auto& factor : separatorFactors_) {
+    const bool involved =
+        any_of(factor->begin(), factor->end(),
+               [&keySet](Key key) { return keySet.count(key) > 0; });
+    (involved ? graph : remaining).push_back(factor);
+  }
+  set<size_t> slots;
+  for (Key key : keys) {
+    for (size_t slot : factorIndex_[key]) {
+      if (factors_[slot] && !eliminatedSlots_.count(slot)) slots.insert(slot);
+    }
+  }
+  for (size_t slot : slots) {
+    graph.push_back(factors_[slot]->linearize(theta_));
+    eliminatedSlots_.insert(slot);
+    activeSlots_.erase(slot);
+  }
+
+  // Variables without any factor stay active
+  const KeySet graphKeys = graph.keys();
+  Ordering ordering;
+  for (Key key : keys) {
+    if (graphKeys.count(key)) ordering.push_back(key);
+  }
+  if (ordering.empty()) {
+    separatorFactors_ = remaining;
+    separatorFactors_.push_back(graph);
+    return;
+  }
+
+  const auto [bayesNet, marginal] = graph.eliminatePartialSequential(
+      ordering, parameters_.getEliminationFunction());
+  for (const auto& conditional : *bayesNet) pushConditional(conditional);
+  remaining.push_back(*marginal);
+  separatorFactors_ = remaining;
+}
+
+/* ************************************************************************* */
+void BatchFixedLagSmoother::marginalizeEliminated(
+    const KeyVector& marginalizeKeys) {
+  const KeySet marginalizeSet(marginalizeKeys.begin(), marginalizeKeys.end());
+
+  // The variables were eliminated first if their conditionals come first,
+  // otherwise eliminate everything again with them first
+  auto eliminatedFirst = [&]() {
+    size_t prefix = 0;
+    while (prefix < conditionals_.size() &&
+           marginalizeSet.count(conditionals_[prefix]->firstFrontalKey()))
+      ++prefix;
+    return prefix;
+  };
+  size_t prefix = eliminatedFirst();
+  size_t eliminated = 0;
+  for (Key key : marginalizeKeys) eliminated += eliminatedKeys_.count(key);
+  if (prefix < eliminated) {
+    KeyVector order = marginalizeKeys;
+    for (const auto& conditional : conditionals_) {
+      if (!marginalizeSet.count(conditional->firstFrontalKey()))
+        order.push_back(conditional->firstFrontalKey());
+    }
+    KeySet allEliminated;
+    for (const auto& key_position : eliminatedKeys_)
+      allEliminated.insert(key_position.first);
+    reactivate(allEliminated);
+    eliminate(order);
+    prefix = eliminatedFirst();
+  }
+
+  // Dropping the conditionals integrates the variables out
+  for (size_t i = 0; i < prefix; ++i) forgetConditional(conditionals_[i]);
+  conditionals_.erase(conditionals_.begin(), conditionals_.begin() + prefix);
+  firstPosition_ += prefix;
+  for (Key key : marginalizeKeys) {
+    eliminatedKeys_.erase(key);
+    activeKeys_.erase(key);
+    dependents_.erase(key);
+  }
+
+  // Remove the factors on the variables, which were all eliminated
+  set<size_t> removedFactorSlots;
+  for (Key key : marginalizeKeys) {
+    for (size_t slot : factorIndex_[key]) {
+      if (factors_[slot]) removedFactorSlots.insert(slot);
+    }
+  }
+  removeFactors(removedFactorSlots);
+  for (size_t slot : removedFactorSlots) eliminatedSlots_.erase(slot);
+  eraseKeys(marginalizeKeys);
+}
+
 /* ************************************************************************* */
 void BatchFixedLagSmoother::PrintKeySet(const set<Key>& keys,
     const string& label) {
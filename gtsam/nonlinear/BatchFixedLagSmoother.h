@@ -21,7 +21,10 @@
 #pragma once
 
 #include <gtsam/nonlinear/FixedLagSmoother.h>
+#include <gtsam/linear/GaussianConditional.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <deque>
 #include <queue>
 
 namespace gtsam {
@@ -33,9 +36,27 @@ public:
   /// Typedef for a shared pointer to an Incremental Fixed-Lag Smoother
   typedef std::shared_ptr<BatchFixedLagSmoother> shared_ptr;
 
-  /** default constructor */
-  BatchFixedLagSmoother(double smootherLag = 0.0, const LevenbergMarquardtParams& parameters = LevenbergMarquardtParams(), bool enforceConsistency = true) :
-    FixedLagSmoother(smootherLag), parameters_(parameters), enforceConsistency_(enforceConsistency) { }
+  /**
+   * default constructor
+   *
+   * In incremental mode, the smoother keeps the variables that are not
+   * involved in new factors eliminated between updates, as a Bayes net in
+   * elimination order and linear factors on the remaining, active variables.
+   * Each update eliminates the variables left behind by the new factors, and
+   * L-M only optimizes the active variables, so the cost of an update scales
+   * with the new factors rather than with the lag. Old variables were
+   * eliminated first, so they are marginalized by dropping their
+   * conditionals. A new factor on an eliminated variable, e.g. a loop closure,
+   * turns the conditionals eliminated after it back into linear factors.
+   * Eliminated variables keep their linearization point, which is exact for
+   * linear problems and approximates the batch solution otherwise. Their
+   * deltas are updated by back-substitution only where a parent changed by
+   * more than \c wildfireThreshold, as in ISAM2.
+   */
+  BatchFixedLagSmoother(double smootherLag = 0.0, const LevenbergMarquardtParams& parameters = LevenbergMarquardtParams(), bool enforceConsistency = true,
+                        bool incremental = false, double wildfireThreshold = 0.0) :
+    FixedLagSmoother(smootherLag), parameters_(parameters), enforceConsistency_(enforceConsistency), incremental_(incremental),
+    wildfireThreshold_(wildfireThreshold) { }
 
   /** destructor */
   ~BatchFixedLagSmoother() override {}
@@ -82,7 +103,13 @@ public:
     return parameters_;
   }
 
-  /** Access the current set of factors */
+  /** Whether the smoother runs in incremental mode, see the constructor */
+  bool incremental() const {
+    return incremental_;
+  }
+
+  /** Access the current set of factors. In incremental mode this does not
+   * include the marginal factors, which are part of the eliminated Bayes net. */
   const NonlinearFactorGraph& getFactors() const {
     return factors_;
   }
@@ -92,10 +119,10 @@ public:
     return theta_;
   }
 
-  /** Access the current ordering */
-  const Ordering& getOrdering() const {
-    return ordering_;
-  }
+  /** Access the current ordering. In incremental mode this is the elimination
+   * order of the eliminated variables followed by the ordering of the active
+   * ones, and it is assembled when requested. */
+  const Ordering& getOrdering() const;
 
   /** Access the current set of deltas to the linearization point */
   const VectorValues& getDelta() const {
@@ -130,6 +157,36 @@ protected:
    * smoothing window. This idea is from ??? TODO: Look up paper reference **/
   bool enforceConsistency_;
 
+  /** Incremental mode, see the constructor **/
+  bool incremental_;
+
+  /** Incremental mode: changes in delta up to this size are not propagated by back-substitution **/
+  double wildfireThreshold_;
+
+  /** Incremental mode: conditionals of the eliminated variables, in elimination order **/
+  std::deque<GaussianConditional::shared_ptr> conditionals_;
+
+  /** Incremental mode: position in the elimination order of the first conditional **/
+  size_t firstPosition_ = 0;
+
+  /** Incremental mode: linear factors on the active variables, left by elimination **/
+  GaussianFactorGraph separatorFactors_;
+
+  /** Incremental mode: the eliminated variables with their position in the
+   * elimination order, and the slots of the factors absorbed into them **/
+  std::map<Key, size_t> eliminatedKeys_;
+  std::set<size_t> eliminatedSlots_;
+
+  /** Incremental mode: the active variables and the slots of their factors **/
+  KeySet activeKeys_;
+  std::set<size_t> activeSlots_;
+
+  /** Incremental mode: for each variable, the eliminated variables whose conditionals have it as a parent **/
+  std::map<Key, KeyVector> dependents_;
+
+  /** Incremental mode: the ordering of the active variables in the last update **/
+  Ordering activeOrdering_;
+
   /** The nonlinear factors **/
   NonlinearFactorGraph factors_;
 
@@ -139,8 +196,8 @@ protected:
   /** The set of values involved in current linear factors. **/
   Values linearValues_;
 
-  /** The current ordering */
-  Ordering ordering_;
+  /** The current ordering, assembled by getOrdering() in incremental mode */
+  mutable Ordering ordering_;
 
   /** The current set of linear deltas */
   VectorValues delta_;
@@ -166,9 +223,46 @@ protected:
   /** Optimize the current graph using a modified version of L-M */
   Result optimize();
 
+  /** Optimize the variables in theta using a modified version of L-M. The
+   * linear factors are in terms of delta and are never relinearized. */
+  Result optimize(const NonlinearFactorGraph& factors,
+                  const GaussianFactorGraph& linearFactors,
+                  const Ordering& ordering, Values* theta, VectorValues* delta);
+
   /** Marginalize out selected variables */
   void marginalize(const KeyVector& marginalizableKeys);
 
+  /** Incremental mode: eliminate the active variables not involved in new
+   * factors, reactivating eliminated ones that are, then optimize the active
+   * variables and marginalize */
+  Result updateIncremental(const NonlinearFactorGraph& newFactors,
+                           const Values& newTheta,
+                           const KeyVector& marginalizableKeys);
+
+  /** Incremental mode: turn the conditionals from the first one on any of
+   * the keys onwards back into linear factors */
+  void reactivate(const KeySet& keys);
+
+  /** Incremental mode: eliminate active variables in the given order */
+  void eliminate(const KeyVector& keys);
+
+  /** Incremental mode: append a conditional to the eliminated Bayes net */
+  void pushConditional(const GaussianConditional::shared_ptr& conditional);
+
+  /** Incremental mode: forget the bookkeeping of a conditional that is removed */
+  void forgetConditional(const GaussianConditional::shared_ptr& conditional);
+
+  /** Incremental mode: remove factors that may have been eliminated */
+  void removeEliminatedFactors(const FactorIndices& factorsToRemove);
+
+  /** Incremental mode: update the deltas of the eliminated variables from
+   * the conditionals from position \c firstNew on, which are new, and from
+   * those with a parent whose delta changed */
+  void backSubstitute(const VectorValues& activeDelta, size_t firstNew);
+
+  /** Incremental mode: marginalize out eliminated variables */
+  void marginalizeEliminated(const KeyVector& marginalizableKeys);
+
 private:
   /** Private methods for printing debug information */
   static void PrintKeySet(const std::set<Key>& keys, const std::string& label);
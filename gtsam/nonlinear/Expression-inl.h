@@ -25,6 +25,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 
@@ -200,28 +201,88 @@ inline std::unique_ptr<internal::ExecutionTraceStorage[]> allocAligned(size_t si
       new internal::ExecutionTraceStorage[alignedSize]);
 }
 
+namespace internal {
+
+/**
+ * Execution trace storage that is reused by all expression evaluations on a
+ * thread. Buffers are acquired and released in LIFO order, one per nesting
+ * level, so an expression function that itself evaluates an expression gets
+ * its own buffer. Buffers only ever grow, so in steady state evaluating
+ * expressions does not allocate. Use through ScopedTraceStorage.
+ */
+class TraceArena {
+  std::vector<std::pair<std::unique_ptr<ExecutionTraceStorage[]>, size_t> >
+      buffers_;      ///< Buffer and its size in bytes, per nesting level
+  size_t depth_ = 0; ///< Number of buffers in use
+
+ public:
+  /// The arena of the calling thread
+  static TraceArena& ThreadLocal() {
+    thread_local TraceArena arena;
+    return arena;
+  }
+
+  /// Acquire a buffer of at least size bytes, aligned to TraceAlignment
+  char* acquire(size_t size) {
+    if (depth_ == buffers_.size()) buffers_.emplace_back(nullptr, 0);
+    auto& buffer = buffers_[depth_];
+    if (buffer.second < size) {
+      buffer.first = allocAligned(size);
+      buffer.second = size;
+    }
+    // Only claim the level once allocation succeeded, so a throwing acquire
+    // leaves the arena balanced
+    ++depth_;
+    return reinterpret_cast<char*>(buffer.first.get());
+  }
+
+  /// Release the most recently acquired buffer
+  void release() { --depth_; }
+};
+
+/// Buffer of a TraceArena of the calling thread, released when out of scope
+class ScopedTraceStorage {
+  TraceArena& arena_;
+  char* storage_;
+
+ public:
+  explicit ScopedTraceStorage(size_t size)
+      : arena_(TraceArena::ThreadLocal()), storage_(arena_.acquire(size)) {}
+  ~ScopedTraceStorage() { arena_.release(); }
+  ScopedTraceStorage(const ScopedTraceStorage&) = delete;
+  ScopedTraceStorage& operator=(const ScopedTraceStorage&) = delete;
+
+  /// The storage, of at least the requested size
+  char* get() const { return storage_; }
+};
+
+}  // namespace internal
+
 template<typename T>
 T Expression<T>::valueAndJacobianMap(const Values& values,
     internal::JacobianMap& jacobians) const {
   try {
-    // We allocate a single block of aligned memory using a unique_ptr.
-    const size_t size = traceSize();
-    auto traceStorage = allocAligned(size);
-
-    // The traceExecution call then fills this memory
-    // with an execution trace, made up entirely of "Record" structs, see
-    // the FunctionalNode class in expression-inl.h
-    internal::ExecutionTrace<T> trace;
-    T value(this->traceExecution(values, trace, reinterpret_cast<char *>(traceStorage.get())));
-
-    // We then calculate the Jacobians using reverse automatic differentiation (AD).
-    trace.startReverseAD1(jacobians);
-    return value;
+    // The execution trace goes into reusable per-thread storage
+    internal::ScopedTraceStorage traceStorage(traceSize());
+    return valueAndJacobianMap(values, jacobians, traceStorage.get());
   } catch (const std::bad_alloc &e) {
     std::cerr << "valueAndJacobianMap exception: " << e.what() << '\n';
     throw e;
   }
-  // Here traceStorage will be de-allocated properly.
+}
+
+template<typename T>
+T Expression<T>::valueAndJacobianMap(const Values& values,
+    internal::JacobianMap& jacobians, char* traceStorage) const {
+  // The traceExecution call fills traceStorage
+  // with an execution trace, made up entirely of "Record" structs, see
+  // the FunctionalNode class in expression-inl.h
+  internal::ExecutionTrace<T> trace;
+  T value(this->traceExecution(values, trace, traceStorage));
+
+  // We then calculate the Jacobians using reverse automatic differentiation (AD).
+  trace.startReverseAD1(jacobians);
+  return value;
 }
 
 template<typename T>
@@ -203,6 +203,11 @@ protected:
   T valueAndJacobianMap(const Values& values,
       internal::JacobianMap& jacobians) const;
 
+  /// Return value and derivatives, tracing the execution in caller-provided
+  /// storage of at least traceSize() bytes, aligned to internal::TraceAlignment
+  T valueAndJacobianMap(const Values& values, internal::JacobianMap& jacobians,
+      char* traceStorage) const;
+
   // be very selective on who can access these private methods:
   friend class ExpressionFactor<T> ;
   friend class internal::ExpressionNode<T>;
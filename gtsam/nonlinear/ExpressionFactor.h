@@ -24,8 +24,10 @@
 #include <gtsam/base/Testable.h>
 #include <gtsam/nonlinear/Expression.h>
 #include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/StaticExpression.h>
 
 #include <numeric>
+#include <type_traits>
 #include <utility>
 
 namespace gtsam {
@@ -55,6 +57,9 @@ protected:
   Expression<T> expression_;  ///< the expression that is AD enabled
   FastVector<int> dims_;      ///< dimensions of the Jacobian matrices
 
+  /// Fused kernel evaluating expression_, if created from a StaticExpression
+  std::shared_ptr<const internal::StaticExpressionKernel<T> > kernel_;
+
 
  public:
 
@@ -75,6 +80,18 @@ protected:
     initialize(expression);
   }
 
+  /**
+   * Constructor from a StaticExpression, which is evaluated by a single fused
+   * kernel rather than by traversing an expression tree
+   */
+  template <class EXPRESSION>
+  ExpressionFactor(const SharedNoiseModel& noiseModel,  //
+                   const T& measurement,
+                   const StaticExpression<EXPRESSION>& expression)
+      : NoiseModelFactor(noiseModel), measured_(measurement) {
+    initialize(expression);
+  }
+
   /// Destructor
   ~ExpressionFactor() override {}
 
@@ -103,13 +120,20 @@ protected:
    */
   Vector unwhitenedError(const Values& x,
     OptionalMatrixVecType H = nullptr) const override {
-    if (H) {
+    if (H && kernel_) {
+      VerticalBlockMatrix Ab(dims_, Dim);
+      Ab.matrix().setZero();
+      internal::JacobianMap jacobianMap(keys_, Ab);
+      const T value = kernel_->valueAndJacobianMap(x, jacobianMap);
+      for (size_t i = 0; i < size(); i++) (*H)[i] = Ab(i);
+      return -traits<T>::Local(value, measured_);
+    } else if (H) {
       const T value = expression_.valueAndDerivatives(x, keys_, dims_, *H);
       // NOTE(hayk): Doing the reverse, AKA Local(measured_, value) is not correct here
       // because it would use the tangent space of the measurement instead of the value.
       return -traits<T>::Local(value, measured_);
     } else {
-      const T value = expression_.value(x);
+      const T value = kernel_ ? kernel_->value(x) : expression_.value(x);
       return -traits<T>::Local(value, measured_);
     }
   }
@@ -130,26 +154,39 @@ protected:
     std::shared_ptr<JacobianFactor> factor(
         new JacobianFactor(keys_, dims_, Dim, noiseModel));
 
-    // Wrap keys and VerticalBlockMatrix into structure passed to expression_
-    VerticalBlockMatrix& Ab = factor->matrixObject();
-    internal::JacobianMap jacobianMap(keys_, Ab);
-
-    // Zero out Jacobian so we can simply add to it
-    Ab.matrix().setZero();
-
-    // Get value and Jacobians, writing directly into JacobianFactor
-    T value = expression_.valueAndJacobianMap(x, jacobianMap); // <<< Reverse AD happens here !
-
-    // Evaluate error and set RHS vector b
-    Ab(size()).col(0) = traits<T>::Local(value, measured_);
+    // Fill in the JacobianFactor, tracing into reusable per-thread storage
+    internal::ScopedTraceStorage traceStorage(expression_.traceSize());
+    fillJacobian(x, factor->matrixObject(), traceStorage.get());
+    return std::move(factor);
+  }
 
-    // Whiten the corresponding system, Ab already contains RHS
-    if (noiseModel_) {
-      Vector b = Ab(size()).col(0);  // need b to be valid for Robust noise models
-      noiseModel_->WhitenSystem(Ab.matrix(), b);
+  /**
+   * Linearize into \c result, overwriting its VerticalBlockMatrix in place if
+   * it is a JacobianFactor with the layout of this factor that is not shared
+   * with anyone else. Together with the per-thread execution trace storage,
+   * relinearizing a graph of ExpressionFactors with
+   * NonlinearFactorGraph::linearizeInto does not allocate in steady state.
+   * Otherwise falls back to linearize.
+   */
+  void linearizeInto(const Values& x,
+                     std::shared_ptr<GaussianFactor>& result) const override {
+    auto jacobian = dynamic_cast<JacobianFactor*>(result.get());
+    if (!jacobian || result.use_count() != 1 || jacobian->get_model() ||
+        (noiseModel_ && noiseModel_->isConstrained()) ||
+        jacobian->keys() != keys_ ||
+        jacobian->rows() != static_cast<size_t>(Dim) || !active(x)) {
+      result = linearize(x);
+      return;
+    }
+    for (size_t j = 0; j < size(); ++j) {
+      if (jacobian->getDim(jacobian->begin() + j) != DenseIndex(dims_[j])) {
+        result = linearize(x);
+        return;
+      }
     }
 
-    return std::move(factor);
+    internal::ScopedTraceStorage traceStorage(expression_.traceSize());
+    fillJacobian(x, jacobian->matrixObject(), traceStorage.get());
   }
 
   /// @return a deep copy of this factor
@@ -159,6 +196,36 @@ protected:
   }
 
 protected:
+ /**
+  * Fill in the whitened Jacobians and rhs of \c Ab, laid out for keys_ and
+  * dims_, tracing the expression in \c traceStorage of at least
+  * expression_.traceSize() bytes.
+  */
+ void fillJacobian(const Values& x, VerticalBlockMatrix& Ab,
+                   char* traceStorage) const {
+   // Wrap keys and VerticalBlockMatrix into structure passed to expression_
+   internal::JacobianMap jacobianMap(keys_, Ab);
+
+   // Zero out Jacobian so we can simply add to it
+   Ab.matrix().setZero();
+
+   // Get value and Jacobians, writing directly into JacobianFactor
+   T value = kernel_ ? kernel_->valueAndJacobianMap(x, jacobianMap)
+                     : expression_.valueAndJacobianMap(x, jacobianMap, traceStorage); // <<< Reverse AD happens here !
+
+   // Evaluate error and set RHS vector b
+   Ab(size()).col(0) = traits<T>::Local(value, measured_);
+
+   // Whiten the corresponding system, Ab already contains RHS
+   if (noiseModel_) {
+     // need b to be valid for Robust noise models, kept per thread so it is
+     // not reallocated for every factor
+     thread_local Vector b;
+     b = Ab(size()).col(0);
+     noiseModel_->WhitenSystem(Ab.matrix(), b);
+   }
+ }
+
  ExpressionFactor() {}
  /// Default constructor, for serialization
 
@@ -193,6 +260,16 @@ protected:
    }
  }
 
+ /// Initialize with a StaticExpression, evaluated by its fused kernel
+ template <class EXPRESSION>
+ void initialize(const StaticExpression<EXPRESSION>& expression) {
+   static_assert(std::is_same<typename EXPRESSION::type, T>::value,
+                 "StaticExpression must have the measurement type");
+   initialize(expression.derived().expression());
+   kernel_ = std::make_shared<
+       internal::StaticExpressionKernelImpl<EXPRESSION> >(expression.derived());
+ }
+
  /// Recreate expression from keys_ and measured_, used in load below.
  /// Needed to deserialize a derived factor
  virtual Expression<T> expression() const {
@@ -35,7 +35,7 @@ namespace internal {
 inline static void optimizeInPlace(const ISAM2::sharedClique& clique,
                                    VectorValues* result) {
   // parents are assumed to already be solved and available in result
-  result->update(clique->conditional()->solve(*result));
+  clique->optimizeInPlace(result);
 
   // starting from the root, call optimize on each conditional
   for (const ISAM2::sharedClique& child : clique->children)
@@ -45,7 +45,6 @@ inline static void optimizeInPlace(const ISAM2::sharedClique& clique,
 
 /* ************************************************************************* */
 size_t DeltaImpl::UpdateGaussNewtonDelta(const ISAM2::Roots& roots,
-                                           const KeySet& replacedKeys,
                                            double wildfireThreshold,
                                            VectorValues* delta) {
   size_t lastBacksubVariableCount;
@@ -61,7 +60,7 @@ size_t DeltaImpl::UpdateGaussNewtonDelta(const ISAM2::Roots& roots,
     lastBacksubVariableCount = 0;
     for (const ISAM2::sharedClique& root : roots)
       lastBacksubVariableCount += optimizeWildfireNonRecursive(
-          root, wildfireThreshold, replacedKeys, delta);  // modifies delta
+          root, wildfireThreshold, delta);  // modifies delta
 
 #if !defined(NDEBUG) && defined(GTSAM_EXTRA_CONSISTENCY_CHECKS)
     for (VectorValues::const_iterator key_delta = delta->begin();
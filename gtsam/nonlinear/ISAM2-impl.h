@@ -31,8 +31,10 @@
 #include <algorithm>
 #include <limits>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <variant>
+#include <vector>
 
 namespace gtsam {
 
@@ -76,10 +78,10 @@ struct GTSAM_EXPORT DeltaImpl {
   };
 
   /**
-   * Update the Newton's method step point, using wildfire
+   * Update the Newton's method step point, using wildfire, starting from the
+   * cliques flagged with ISAM2Clique::deltaReplaced()
    */
   static size_t UpdateGaussNewtonDelta(const ISAM2::Roots& roots,
-                                       const KeySet& replacedKeys,
                                        double wildfireThreshold,
                                        VectorValues* delta);
 
@@ -368,9 +370,12 @@ struct GTSAM_EXPORT UpdateImpl {
 
   // Mark keys in \Delta above threshold \beta:
   KeySet gatherRelinearizeKeys(const ISAM2::Roots& roots,
+                               const ISAM2::Nodes& nodes,
                                const VectorValues& delta,
                                const KeySet& fixedVariables,
-                               KeySet* markedKeys) const {
+                               KeySet* markedKeys,
+                               KeySet* deferredKeys = nullptr,
+                               double* deferredCost = nullptr) const {
     gttic(gatherRelinearizeKeys);
     // J=\{\Delta_{j}\in\Delta|\Delta_{j}\geq\beta\}.
     KeySet relinKeys =
@@ -391,11 +396,85 @@ struct GTSAM_EXPORT UpdateImpl {
       }
     }
 
+    // Keep only the variables with the largest deltas within the budget
+    if (updateParams_.maxReeliminationCost)
+      DeferRelinearization(nodes, delta, *markedKeys,
+                           *updateParams_.maxReeliminationCost, &relinKeys,
+                           deferredKeys, deferredCost);
+
     // Add the variables being relinearized to the marked keys
     markedKeys->insert(relinKeys.begin(), relinKeys.end());
     return relinKeys;
   }
 
+  // Add the cliques that are re-eliminated because of a marked key to top,
+  // and return their estimated elimination cost. These are the cliques where
+  // the key is frontal and their ancestors and, if the key is relinearized,
+  // the cliques that have it in their separator and their ancestors. By the
+  // running intersection property the latter are all below the clique where
+  // the key is frontal. Cliques already in top are not counted again.
+  static double AddToTop(const ISAM2::Nodes& nodes, Key key, bool relinearized,
+                         std::unordered_set<const ISAM2Clique*>* top) {
+    const auto node = nodes.find(key);
+    if (node == nodes.end()) return 0.0;  // New variable, not in the tree yet
+    double cost = 0.0;
+    std::vector<ISAM2::sharedClique> involved{node->second};
+    for (size_t i = 0; relinearized && i < involved.size(); ++i) {
+      for (const auto& child : involved[i]->children) {
+        const auto& parents = child->conditional()->parents();
+        if (std::find(parents.begin(), parents.end(), key) != parents.end())
+          involved.push_back(child);
+      }
+    }
+    for (ISAM2::sharedClique clique : involved) {
+      for (; clique && top->insert(clique.get()).second;
+           clique = clique->parent()) {
+        const auto& conditional = clique->conditional();
+        cost += ISAM2JunctionTree::Cluster::EliminationCost(
+            conditional->rows(), conditional->S().cols());
+      }
+    }
+    return cost;
+  }
+
+  // Defer the relinearization of the keys with the smallest deltas until the
+  // estimated cost of re-eliminating the top, including the part marked by
+  // new and removed factors, is within budget.
+  static void DeferRelinearization(const ISAM2::Nodes& nodes,
+                                   const VectorValues& delta,
+                                   const KeySet& markedKeys, double budget,
+                                   KeySet* relinKeys, KeySet* deferredKeys,
+                                   double* deferredCost) {
+    gttic(DeferRelinearization);
+    std::unordered_set<const ISAM2Clique*> top;
+    double cost = 0.0;
+    for (Key key : markedKeys) cost += AddToTop(nodes, key, false, &top);
+
+    std::vector<std::pair<double, Key>> priorities;
+    priorities.reserve(relinKeys->size());
+    for (Key key : *relinKeys)
+      priorities.emplace_back(-delta[key].lpNorm<Eigen::Infinity>(), key);
+    std::sort(priorities.begin(), priorities.end());
+
+    // Relinearize in order of decreasing delta while the cost fits, and defer
+    // the rest. The cost of the deferred keys is still accumulated, without
+    // double counting cliques they share.
+    bool deferring = false;
+    double savedCost = 0.0;
+    for (const auto& [priority, key] : priorities) {
+      const double keyCost = AddToTop(nodes, key, true, &top);
+      if (!deferring && cost + keyCost > budget) deferring = true;
+      if (deferring) {
+        savedCost += keyCost;
+        relinKeys->erase(key);
+        if (deferredKeys) deferredKeys->insert(key);
+      } else {
+        cost += keyCost;
+      }
+    }
+    if (deferredCost) *deferredCost = savedCost;
+  }
+
   // Record relinerization threshold keys in detailed results
   void recordRelinearizeDetail(const KeySet& relinKeys,
                                ISAM2Result::DetailedResults* detail) const {
@@ -22,14 +22,26 @@
 
 #include <gtsam/base/debug.h>
 #include <gtsam/base/timing.h>
+#include <gtsam/config.h>  // for GTSAM_USE_TBB
 #include <gtsam/inference/BayesTree-inst.h>
+#include <gtsam/linear/HessianFactor.h>
 #include <gtsam/nonlinear/LinearContainerFactor.h>
 
 #include <algorithm>
+#include <cmath>
+#include <functional>
 #include <map>
+#include <queue>
+#include <tuple>
+#include <unordered_set>
 #include <utility>
 #include <variant>
 
+#ifdef GTSAM_USE_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
+
 using namespace std;
 
 namespace gtsam {
@@ -37,6 +49,22 @@ namespace gtsam {
 // Instantiate base class
 template class BayesTree<ISAM2Clique>;
 
+/* ************************************************************************* */
+// Doubles stored by a linear factor, as counted by ISAM2::memoryUsage()
+static size_t FactorDoubles(const GaussianFactor::shared_ptr& factor) {
+  if (auto jacobian = std::dynamic_pointer_cast<JacobianFactor>(factor))
+    return jacobian->matrixObject().matrix().size();
+  if (auto hessian = std::dynamic_pointer_cast<HessianFactor>(factor))
+    return hessian->info().rows() * hessian->info().cols();
+  return 0;
+}
+
+// Doubles stored by a clique: its conditional and its cached marginal factor
+static size_t CliqueDoubles(const ISAM2Clique& clique) {
+  return clique.conditional()->matrixObject().matrix().size() +
+         FactorDoubles(clique.cachedFactor());
+}
+
 /* ************************************************************************* */
 ISAM2::ISAM2(const ISAM2Params& params) : params_(params), update_count_(0) {
   if (std::holds_alternative<ISAM2DoglegParams>(params_.optimizationParams)) {
@@ -76,7 +104,10 @@ GaussianFactorGraph ISAM2::relinearizeAffectedFactors(
   gttoc(affectedKeysSet);
 
   gttic(check_candidates_and_linearize);
-  GaussianFactorGraph linearized;
+  // Select the factors that only involve affected variables, and among them
+  // those whose cached linear factor is outdated
+  FactorIndices selected;
+  std::vector<size_t> outdated;  // positions in selected
   for (const FactorIndex idx : candidates) {
     bool inside = true;
     bool useCachedLinear = params_.cacheLinearizedFactors;
@@ -89,22 +120,56 @@ GaussianFactorGraph ISAM2::relinearizeAffectedFactors(
         useCachedLinear = false;
     }
     if (inside) {
-      if (useCachedLinear) {
-#ifdef GTSAM_EXTRA_CONSISTENCY_CHECKS
-        assert(linearFactors_[idx]);
-        assert(linearFactors_[idx]->keys() == nonlinearFactors_[idx]->keys());
+      if (!useCachedLinear) outdated.push_back(selected.size());
+      selected.push_back(idx);
+    }
+  }
+
+  // Linearize the outdated factors, overwriting the cached linear factors in
+  // place. Distinct factors write distinct slots, so this runs in parallel.
+  GaussianFactorGraph linearized;
+  linearized.resize(selected.size());
+  auto outdatedDoubles = [&]() {
+    size_t doubles = 0;
+    for (size_t k : outdated)
+      doubles += FactorDoubles(linearFactors_[selected[k]]);
+    return doubles;
+  };
+  const size_t doublesBefore =
+      params_.cacheLinearizedFactors ? outdatedDoubles() : 0;
+  auto linearizeOne = [&](size_t k) {
+    const FactorIndex idx = selected[k];
+    if (params_.cacheLinearizedFactors)
+      nonlinearFactors_[idx]->linearizeInto(theta_, linearFactors_[idx]);
+    else
+      linearized[k] = nonlinearFactors_[idx]->linearize(theta_);
+  };
+#ifdef GTSAM_USE_TBB
+  TbbOpenMPMixedScope threadLimiter;  // Limits OpenMP threads since we're
+                                      // mixing TBB and OpenMP
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, outdated.size()),
+                    [&](const tbb::blocked_range<size_t>& range) {
+                      for (size_t i = range.begin(); i != range.end(); ++i)
+                        if (nonlinearFactors_[selected[outdated[i]]]->sendable())
+                          linearizeOne(outdated[i]);
+                    });
+  // Factors that are not sendable are linearized on this thread
+  for (size_t k : outdated)
+    if (!nonlinearFactors_[selected[k]]->sendable()) linearizeOne(k);
+#else
+  for (size_t k : outdated) linearizeOne(k);
 #endif
-        linearized.push_back(linearFactors_[idx]);
-      } else {
-        auto linearFactor = nonlinearFactors_[idx]->linearize(theta_);
-        linearized.push_back(linearFactor);
-        if (params_.cacheLinearizedFactors) {
+
+  // Cached factors are only shared with the result after linearization, so
+  // that they can be overwritten in place above
+  if (params_.cacheLinearizedFactors) {
+    memoryDoubles_ = memoryDoubles_ - doublesBefore + outdatedDoubles();
+    for (size_t k = 0; k < selected.size(); ++k) {
 #ifdef GTSAM_EXTRA_CONSISTENCY_CHECKS
-          assert(linearFactors_[idx]->keys() == linearFactor->keys());
+      assert(linearFactors_[selected[k]]->keys() ==
+             nonlinearFactors_[selected[k]]->keys());
 #endif
-          linearFactors_[idx] = linearFactor;
-        }
-      }
+      linearized[k] = linearFactors_[selected[k]];
     }
   }
   gttoc(check_candidates_and_linearize);
@@ -125,6 +190,15 @@ void ISAM2::recalculate(const ISAM2UpdateParams& updateParams,
     // removed cliques.
     GaussianBayesNet affectedBayesNet;
     Cliques orphans;
+    std::unordered_set<const ISAM2Clique*> removed;
+    for (Key key : result->markedKeys) {
+      auto node = nodes_.find(key);
+      if (node == nodes_.end()) continue;
+      for (sharedClique clique = node->second;
+           clique && removed.insert(clique.get()).second;
+           clique = clique->parent())
+        memoryDoubles_ -= CliqueDoubles(*clique);
+    }
     this->removeTop(
         KeyVector(result->markedKeys.begin(), result->markedKeys.end()),
         &affectedBayesNet, &orphans);
@@ -214,14 +288,20 @@ void ISAM2::recalculateBatch(const ISAM2UpdateParams& updateParams,
   gttoc(ordering);
 
   gttic(linearize);
-  auto linearized = nonlinearFactors_.linearize(theta_);
-  if (params_.cacheLinearizedFactors) linearFactors_ = *linearized;
+  // Cached linear factors are relinearized in place
+  GaussianFactorGraph::shared_ptr uncached;
+  if (params_.cacheLinearizedFactors)
+    nonlinearFactors_.linearizeInto(theta_, linearFactors_);
+  else
+    uncached = nonlinearFactors_.linearize(theta_);
+  const GaussianFactorGraph& linearized =
+      params_.cacheLinearizedFactors ? linearFactors_ : *uncached;
   gttoc(linearize);
 
   gttic(eliminate);
   ISAM2BayesTree::shared_ptr bayesTree =
       ISAM2JunctionTree(
-          GaussianEliminationTree(*linearized, affectedFactorsVarIndex, order))
+          GaussianEliminationTree(linearized, affectedFactorsVarIndex, order))
           .eliminate(params_.getEliminationFunction())
           .first;
   gttoc(eliminate);
@@ -236,6 +316,7 @@ void ISAM2::recalculateBatch(const ISAM2UpdateParams& updateParams,
 
   result->variablesReeliminated = affectedKeysSet->size();
   result->factorsRecalculated = nonlinearFactors_.size();
+  recountMemoryUsage();
 
   // Reeliminated keys for detailed results
   if (params_.enableDetailedResults) {
@@ -355,6 +436,9 @@ void ISAM2::recalculateIncremental(const ISAM2UpdateParams& updateParams,
   roots_.insert(roots_.end(), bayesTree->roots().begin(),
                 bayesTree->roots().end());
   nodes_.insert(bayesTree->nodes().begin(), bayesTree->nodes().end());
+  for (const auto& [key, clique] : bayesTree->nodes())
+    if (key == clique->conditional()->front())
+      memoryDoubles_ += CliqueDoubles(*clique);
   gttoc(reassemble);
 
   // 4. The orphans have already been inserted during elimination
@@ -366,6 +450,8 @@ void ISAM2::addVariables(const Values& newTheta,
   gttic(addNewVariables);
 
   theta_.insert(newTheta);
+  // theta_, delta_, deltaNewton_ and RgProd_
+  memoryDoubles_ += 4 * newTheta.dim();
   if (ISDEBUG("ISAM2 AddVariables")) newTheta.print("The new variables are: ");
   // Add zeros into the VectorValues
   delta_.insert(newTheta.zeroVectors());
@@ -386,6 +472,8 @@ void ISAM2::removeVariables(const KeySet& unusedKeys) {
 
   variableIndex_.removeUnusedVariables(unusedKeys.begin(), unusedKeys.end());
   for (Key key : unusedKeys) {
+    auto it = delta_.find(key);
+    if (it != delta_.end()) memoryDoubles_ -= 4 * it->second.size();
     delta_.erase(key);
     deltaNewton_.erase(key);
     RgProd_.erase(key);
@@ -393,9 +481,75 @@ void ISAM2::removeVariables(const KeySet& unusedKeys) {
     Base::nodes_.unsafe_erase(key);
     theta_.erase(key);
     fixedVariables_.erase(key);
+    lastTouched_.erase(key);
   }
 }
 
+/* ************************************************************************* */
+void ISAM2::enforceMemoryLimits(ISAM2Result* result) {
+  gttic(enforceMemoryLimits);
+  // Leaf cliques, including roots but not those touched by the current
+  // update, least recently touched first. Cliques only become leaves when their
+  // children are marginalized, so the tree is scanned once.
+  using Candidate = std::tuple<int, Key, sharedClique>;
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>>
+      leaves;
+  auto addIfLeaf = [&](const sharedClique& clique) {
+    if (!clique->children.empty()) return;
+    int touched = 0;
+    for (Key frontal : clique->conditional()->frontals()) {
+      auto it = lastTouched_.find(frontal);
+      if (it != lastTouched_.end()) touched = std::max(touched, it->second);
+    }
+    if (touched < update_count_)
+      leaves.emplace(touched, clique->conditional()->front(), clique);
+  };
+  for (const auto& [key, clique] : nodes_)
+    if (key == clique->conditional()->front()) addIfLeaf(clique);
+
+  ISAM2MemoryUsage usage = memoryUsage();
+  while (true) {
+    // Fraction of the variables to marginalize, assuming that the factors and
+    // bytes shrink in proportion to the variables
+    double fraction = 0.0;
+    auto checkLimit = [&fraction](const std::optional<size_t>& limit,
+                                  size_t used) {
+      if (limit && used > *limit)
+        fraction = std::max(fraction, double(used - *limit) / used);
+    };
+    checkLimit(params_.maxVariables, usage.variables);
+    checkLimit(params_.maxFactors, usage.factors);
+    checkLimit(params_.maxBytes, usage.bytes);
+    if (fraction == 0.0) break;
+    if (leaves.empty()) {
+      result->withinMemoryLimits = false;
+      break;
+    }
+    const size_t target =
+        std::max<size_t>(1, std::ceil(fraction * usage.variables));
+
+    // Parents may become leaves, so the remainder is left for the next round
+    FastList<Key> leafKeys;
+    Cliques parents;
+    while (!leaves.empty() && leafKeys.size() < target) {
+      const sharedClique clique = std::get<2>(leaves.top());
+      leaves.pop();
+      const auto& conditional = clique->conditional();
+      leafKeys.insert(leafKeys.end(), conditional->beginFrontals(),
+                      conditional->endFrontals());
+      if (clique->parent()) parents.push_back(clique->parent());
+    }
+    result->marginalizedKeys.insert(result->marginalizedKeys.end(),
+                                    leafKeys.begin(), leafKeys.end());
+    marginalizeLeaves(leafKeys);
+    parents.sort();
+    parents.unique();
+    for (const sharedClique& parent : parents) addIfLeaf(parent);
+    usage = memoryUsage();
+  }
+  result->memory = usage;
+}
+
 /* ************************************************************************* */
 ISAM2Result ISAM2::update(
     const NonlinearFactorGraph& newFactors, const Values& newTheta,
@@ -420,6 +574,7 @@ ISAM2Result ISAM2::update(const NonlinearFactorGraph& newFactors,
                           const ISAM2UpdateParams& updateParams) {
   gttic(ISAM2_update);
   this->update_count_ += 1;
+  covariancesStale_ = true;
   UpdateImpl::LogStartingUpdate(newFactors, *this);
   ISAM2Result result(params_.enableDetailedResults);
   UpdateImpl update(params_, updateParams);
@@ -429,6 +584,17 @@ ISAM2Result ISAM2::update(const NonlinearFactorGraph& newFactors,
     updateDelta(updateParams.forceFullSolve);
 
   // 1. Add any new factors \Factors:=\Factors\cup\Factors'.
+  for (const FactorIndex index : FactorIndexSet(
+           updateParams.removeFactorIndices.begin(),
+           updateParams.removeFactorIndices.end())) {
+    if (index >= nonlinearFactors_.size() || !nonlinearFactors_[index])
+      continue;
+    --nrFactors_;
+    if (params_.cacheLinearizedFactors && index < linearFactors_.size())
+      memoryDoubles_ -= FactorDoubles(linearFactors_[index]);
+  }
+  for (const auto& factor : newFactors)
+    if (factor) ++nrFactors_;
   update.pushBackFactors(newFactors, &nonlinearFactors_, &linearFactors_,
                          &variableIndex_, &result.newFactorsIndices,
                          &result.keysWithRemovedFactors);
@@ -438,6 +604,10 @@ ISAM2Result ISAM2::update(const NonlinearFactorGraph& newFactors,
   // 2. Initialize any new variables \Theta_{new} and add
   // \Theta:=\Theta\cup\Theta_{new}.
   addVariables(newTheta, result.details());
+  if (params_.hasMemoryLimits()) {
+    for (Key key : newFactors.keys()) lastTouched_[key] = update_count_;
+    for (Key key : newTheta.keys()) lastTouched_[key] = update_count_;
+  }
   if (params_.evaluateNonlinearError)
     update.error(nonlinearFactors_, calculateEstimate(), &result.errorBefore);
 
@@ -450,8 +620,9 @@ ISAM2Result ISAM2::update(const NonlinearFactorGraph& newFactors,
   result.variablesRelinearized = 0;
   if (update.relinarizationNeeded(update_count_)) {
     // 4. Mark keys in \Delta above threshold \beta:
-    relinKeys = update.gatherRelinearizeKeys(roots_, delta_, fixedVariables_,
-                                             &result.markedKeys);
+    relinKeys = update.gatherRelinearizeKeys(
+        roots_, nodes_, delta_, fixedVariables_, &result.markedKeys,
+        &result.deferredRelinKeys, &result.deferredCost);
     update.recordRelinearizeDetail(relinKeys, result.details());
     if (!relinKeys.empty()) {
       // 5. Mark cliques that involve marked variables \Theta_{J} and ancestors.
@@ -466,12 +637,32 @@ ISAM2Result ISAM2::update(const NonlinearFactorGraph& newFactors,
   // 7. Linearize new factors
   update.linearizeNewFactors(newFactors, theta_, nonlinearFactors_.size(),
                              result.newFactorsIndices, &linearFactors_);
+  if (params_.cacheLinearizedFactors)
+    for (const FactorIndex index : result.newFactorsIndices)
+      memoryDoubles_ += FactorDoubles(linearFactors_[index]);
   update.augmentVariableIndex(newFactors, result.newFactorsIndices,
                               &variableIndex_);
 
   // 8. Redo top of Bayes tree and update data structures
   recalculate(updateParams, relinKeys, &result);
   if (!result.unusedKeys.empty()) removeVariables(result.unusedKeys);
+
+  // 9. Marginalize old variables to stay within the memory limits
+  if (params_.hasMemoryLimits())
+    enforceMemoryLimits(&result);
+  else if (params_.enableDetailedResults)
+    result.memory = memoryUsage();
+
+  // 10. Remove empty factor slots
+  if (params_.compactionThreshold) {
+    const size_t slots = nonlinearFactors_.size();
+    if (slots - nonlinearFactors_.nrFactors() >
+        *params_.compactionThreshold * slots) {
+      result.factorIndexMap = compactFactors();
+      for (FactorIndex& index : result.newFactorsIndices)
+        index = result.factorIndexMap[index];
+    }
+  }
   result.cliques = this->nodes().size();
 
   if (params_.evaluateNonlinearError)
@@ -486,6 +677,7 @@ void ISAM2::marginalizeLeaves(
     FactorIndices* deletedFactorsIndices) {
   // Convert to ordered set
   KeySet leafKeys(leafKeysList.begin(), leafKeysList.end());
+  covariancesStale_ = true;
 
   // Keep track of marginal factors - map from clique to the marginal factors
   // that should be incorporated into it, passed up from it's children.
@@ -502,6 +694,7 @@ void ISAM2::marginalizeLeaves(
   auto trackingRemoveSubtree = [&](const sharedClique& subtreeRoot) {
     const Cliques removedCliques = this->removeSubtree(subtreeRoot);
     for (const sharedClique& removedClique : removedCliques) {
+      memoryDoubles_ -= CliqueDoubles(*removedClique);
       auto cg = removedClique->conditional();
       marginalFactors.erase(cg->front());
       leafKeysRemoved.insert(cg->beginFrontals(), cg->endFrontals());
@@ -670,7 +863,9 @@ void ISAM2::marginalizeLeaves(
   for (const auto index : factorIndicesToRemove) {
     removedFactors.push_back(nonlinearFactors_[index]);
     nonlinearFactors_.remove(index);
+    --nrFactors_;
     if (params_.cacheLinearizedFactors) {
+      memoryDoubles_ -= FactorDoubles(linearFactors_[index]);
       linearFactors_.remove(index);
     }
   }
@@ -694,11 +889,13 @@ void ISAM2::marginalizeLeaves(
   // Add the nonlinear factors and keep track of the new factor indices
   auto newFactorIndices = nonlinearFactors_.add_factors(nonlinearFactorsToAdd,
                                                         params_.findUnusedFactorSlots);
+  nrFactors_ += nonlinearFactorsToAdd.size();
   // Add cached linear factors.
   if (params_.cacheLinearizedFactors){
     linearFactors_.resize(nonlinearFactors_.size());
     for (std::size_t i = 0; i < nonlinearFactorsToAdd.size(); ++i){
       linearFactors_[newFactorIndices[i]] = factorsToAdd[i];
+      memoryDoubles_ += FactorDoubles(factorsToAdd[i]);
     }
   }
   // Augment the variable index
@@ -727,8 +924,8 @@ void ISAM2::updateDelta(bool forceFullSolve) const {
     const double effectiveWildfireThreshold =
         forceFullSolve ? 0.0 : gaussNewtonParams.wildfireThreshold;
     gttic(Wildfire_update);
-    DeltaImpl::UpdateGaussNewtonDelta(roots_, deltaReplacedMask_,
-                                      effectiveWildfireThreshold, &delta_);
+    DeltaImpl::UpdateGaussNewtonDelta(roots_, effectiveWildfireThreshold,
+                                      &delta_);
     deltaReplacedMask_.clear();
     gttoc(Wildfire_update);
   } else if (std::holds_alternative<ISAM2DoglegParams>(params_.optimizationParams)) {
@@ -743,8 +940,8 @@ void ISAM2::updateDelta(bool forceFullSolve) const {
 
     // Compute Newton's method step
     gttic(Wildfire_update);
-    DeltaImpl::UpdateGaussNewtonDelta(
-        roots_, deltaReplacedMask_, effectiveWildfireThreshold, &deltaNewton_);
+    DeltaImpl::UpdateGaussNewtonDelta(roots_, effectiveWildfireThreshold,
+                                      &deltaNewton_);
     gttoc(Wildfire_update);
 
     // Compute steepest descent step
@@ -806,6 +1003,62 @@ Matrix ISAM2::marginalCovariance(Key key) const {
       .inverse();
 }
 
+/* ************************************************************************* */
+const BayesTreeCovariances<ISAM2Clique>& ISAM2::covariances() const {
+  if (covariancesStale_) {
+    covariances_.update(*this);
+    covariancesStale_ = false;
+  }
+  return covariances_;
+}
+
+/* ************************************************************************* */
+ISAM2MemoryUsage ISAM2::memoryUsage() const {
+  ISAM2MemoryUsage usage;
+  usage.variables = theta_.size();
+  usage.factors = nrFactors_;
+  usage.bytes = memoryDoubles_ * sizeof(double);
+  return usage;
+}
+
+/* ************************************************************************* */
+void ISAM2::recountMemoryUsage() {
+  nrFactors_ = nonlinearFactors_.nrFactors();
+  memoryDoubles_ = 0;
+  for (const auto& [key, clique] : nodes_) {
+    // Count each clique once, by its first frontal variable
+    if (key == clique->conditional()->front())
+      memoryDoubles_ += CliqueDoubles(*clique);
+  }
+  if (params_.cacheLinearizedFactors)
+    for (const auto& factor : linearFactors_)
+      memoryDoubles_ += FactorDoubles(factor);
+  // theta_, delta_, deltaNewton_ and RgProd_
+  memoryDoubles_ += 4 * theta_.dim();
+}
+
+/* ************************************************************************* */
+FactorIndices ISAM2::compactFactors() {
+  gttic(compactFactors);
+  FactorIndices newIndices(nonlinearFactors_.size(), kEmptyFactorSlot);
+  NonlinearFactorGraph nonlinearFactors;
+  GaussianFactorGraph linearFactors;
+  const size_t nrFactors = nonlinearFactors_.nrFactors();
+  nonlinearFactors.reserve(nrFactors);
+  linearFactors.reserve(nrFactors);
+  for (size_t i = 0; i < nonlinearFactors_.size(); ++i) {
+    if (!nonlinearFactors_[i]) continue;
+    newIndices[i] = nonlinearFactors.size();
+    nonlinearFactors.push_back(nonlinearFactors_[i]);
+    linearFactors.push_back(i < linearFactors_.size() ? linearFactors_[i]
+                                                      : nullptr);
+  }
+  nonlinearFactors_ = std::move(nonlinearFactors);
+  linearFactors_ = std::move(linearFactors);
+  variableIndex_.renumberFactors(newIndices, nonlinearFactors_.size());
+  return newIndices;
+}
+
 /* ************************************************************************* */
 const VectorValues& ISAM2::getDelta() const {
   if (!deltaReplacedMask_.empty()) updateDelta();
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <gtsam/linear/BayesTreeCovariances.h>
 #include <gtsam/linear/GaussianBayesTree.h>
 #include <gtsam/nonlinear/ISAM2Clique.h>
 #include <gtsam/nonlinear/ISAM2Params.h>
@@ -27,6 +28,9 @@
 #include <gtsam/nonlinear/ISAM2UpdateParams.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 
+#include <iosfwd>
+#include <limits>
+#include <string>
 #include <vector>
 
 namespace gtsam {
@@ -71,7 +75,8 @@ class GTSAM_EXPORT ISAM2 : public BayesTree<ISAM2Clique> {
    * or calculateEstimate().
    *
    * This is \c mutable because it is used internally to not update delta_
-   * until it is needed.
+   * until it is needed. The Gauss-Newton wildfire itself does not look up
+   * keys here, it uses the per-clique flag ISAM2Clique::deltaReplaced().
    */
   mutable KeySet deltaReplacedMask_;  // TODO(dellaert): Make sure accessed in
                                       // the right way
@@ -96,6 +101,19 @@ class GTSAM_EXPORT ISAM2 : public BayesTree<ISAM2Clique> {
   int update_count_;  ///< Counter incremented every update(), used to determine
                       ///< periodic relinearization
 
+  /// Covariances of all variables, recomputed by covariances() when stale
+  mutable BayesTreeCovariances<ISAM2Clique> covariances_;
+  mutable bool covariancesStale_ = true;
+
+  /// Value of update_count_ at the last update that added each variable or a
+  /// factor on it, only kept when ISAM2Params has memory limits
+  FastMap<Key, int> lastTouched_;
+
+  /// Number of nonlinear factors and of doubles counted by memoryUsage(), kept
+  /// up to date by every change to the factors, Bayes tree and variables
+  size_t nrFactors_ = 0;
+  size_t memoryDoubles_ = 0;
+
  public:
   using This = ISAM2;                       ///< This class
   using Base = BayesTree<ISAM2Clique>;      ///< The BayesTree base class
@@ -251,6 +269,65 @@ class GTSAM_EXPORT ISAM2 : public BayesTree<ISAM2Clique> {
   /** Return marginal on any variable as a covariance matrix */
   Matrix marginalCovariance(Key key) const;
 
+  /** Marginal covariances of all variables, and the covariance blocks of
+   * variables that share a clique, see BayesTreeCovariances. Recomputed in one
+   * pass over the Bayes tree on the first call after an update, which only
+   * inverts again the conditionals of re-eliminated cliques. */
+  const BayesTreeCovariances<ISAM2Clique>& covariances() const;
+
+  /** The number of variables and factors, and an estimate of the bytes used by
+   * the numerical data, see ISAM2MemoryUsage. Constant time, the counts are
+   * kept up to date by update() and marginalizeLeaves(). */
+  ISAM2MemoryUsage memoryUsage() const;
+
+  /// Index in the tables returned by compactFactors() of empty factor slots
+  static constexpr FactorIndex kEmptyFactorSlot =
+      std::numeric_limits<FactorIndex>::max();
+
+  /**
+   * Remove the empty factor slots left by removed and marginalized factors,
+   * renumbering the remaining factors in their current order. The nonlinear
+   * and cached linear factors are packed, and the variable index renumbered
+   * and trimmed. Factor indices kept by the caller, e.g. from
+   * ISAM2Result::newFactorsIndices, must be translated through the returned
+   * table before being used to remove factors.
+   * @return The new index of each factor, by its index before compaction, or
+   * kEmptyFactorSlot for empty slots.
+   */
+  FactorIndices compactFactors();
+
+#ifdef GTSAM_ENABLE_BOOST_SERIALIZATION
+  /**
+   * Write a binary checkpoint of the state of this ISAM2, from which
+   * loadCheckpoint() restores it quickly to continue incremental updates.
+   * The numerical state is stored as flat arrays in native byte order: the
+   * conditionals and cached factors of the Bayes tree, the cached linear
+   * factors and the linear deltas. Only the linearization point and the
+   * nonlinear factors, which are polymorphic, go through Boost binary
+   * archives, so their types must be exported as for Boost serialization.
+   * The parameters are not stored. Throws std::invalid_argument if a linear
+   * factor is neither a JacobianFactor nor a HessianFactor.
+   */
+  void saveCheckpoint(std::ostream& os) const;
+
+  /// Write a binary checkpoint to a file, see saveCheckpoint(std::ostream&)
+  void saveCheckpoint(const std::string& filename) const;
+
+  /**
+   * Replace the state of this ISAM2 by a checkpoint written by
+   * saveCheckpoint(), keeping its parameters. The checkpoint is read from a
+   * contiguous buffer, e.g. a memory-mapped checkpoint file, and is not
+   * referenced after the call. The variable index is rebuilt from the
+   * nonlinear factors. The first update after loading back-substitutes the
+   * whole Bayes tree, as after a batch step. Throws if the checkpoint is
+   * truncated or corrupt, in which case this ISAM2 is unchanged.
+   */
+  void loadCheckpoint(const char* data, size_t size);
+
+  /// Load a binary checkpoint from a file, see loadCheckpoint(const char*, size_t)
+  void loadCheckpoint(const std::string& filename);
+#endif
+
   /// @name Public members for non-typical usage
   /// @{
 
@@ -337,6 +414,16 @@ class GTSAM_EXPORT ISAM2 : public BayesTree<ISAM2Clique> {
    */
   void removeVariables(const KeySet& unusedKeys);
 
+  /**
+   * Marginalize the least recently touched leaf cliques until the system is
+   * within the memory limits of ISAM2Params, see ISAM2Params::maxVariables.
+   * @param result [output] Receives the marginalized keys and the memory usage.
+   */
+  void enforceMemoryLimits(ISAM2Result* result);
+
+  /// Recount the factors and doubles of memoryUsage() over the whole system
+  void recountMemoryUsage();
+
   void updateDelta(bool forceFullSolve = false) const;
 
  private:
@@ -357,6 +444,12 @@ class GTSAM_EXPORT ISAM2 : public BayesTree<ISAM2Clique> {
       ar & BOOST_SERIALIZATION_NVP(doglegDelta_);
       ar & BOOST_SERIALIZATION_NVP(fixedVariables_);
       ar & BOOST_SERIALIZATION_NVP(update_count_);
+      // Covariances of a previous Bayes tree are not valid for the loaded one
+      if (ARCHIVE::is_loading::value) {
+        covariances_ = BayesTreeCovariances<ISAM2Clique>();
+        covariancesStale_ = true;
+        recountMemoryUsage();
+      }
   }
 #endif
 
@@ -0,0 +1,430 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    ISAM2Checkpoint.cpp
+ * @brief   Binary checkpoints of ISAM2, see ISAM2::saveCheckpoint()
+ */
+
+#include <gtsam/nonlinear/ISAM2.h>
+
+#ifdef GTSAM_ENABLE_BOOST_SERIALIZATION
+
+#include <gtsam/base/serialization.h>
+#include <gtsam/base/timing.h>
+#include <gtsam/inference/BayesTree-inst.h>
+#include <gtsam/linear/HessianFactor.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace gtsam {
+
+namespace {
+
+const char kMagic[8] = {'G', 'T', 'S', 'A', 'M', 'I', '2', 'C'};
+const uint32_t kVersion = 1;
+const uint32_t kByteOrder = 0x01020304;
+
+enum FactorTag : uint8_t { kNullFactor, kJacobianFactor, kHessianFactor };
+enum ModelTag : uint8_t { kNoModel, kUnit, kIsotropic, kDiagonal, kConstrained };
+
+/// Writes plain data and flat arrays in native byte order
+class Writer {
+  std::ostream& os_;
+
+ public:
+  explicit Writer(std::ostream& os) : os_(os) {}
+
+  template <typename T>
+  void pod(const T& value) {
+    os_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  void array(const T* data, size_t n) {
+    pod<uint64_t>(n);
+    os_.write(reinterpret_cast<const char*>(data), n * sizeof(T));
+  }
+
+  template <typename CONTAINER>
+  void keys(const CONTAINER& keys) {
+    const std::vector<Key> flat(keys.begin(), keys.end());
+    array(flat.data(), flat.size());
+  }
+
+  void vector(const Vector& v) { array(v.data(), v.size()); }
+
+  void matrix(const Matrix& m) {
+    pod<uint64_t>(m.rows());
+    array(m.data(), m.size());
+  }
+
+  void vectorValues(const VectorValues& values) {
+    pod<uint64_t>(values.size());
+    for (const auto& [key, value] : values) {
+      pod<Key>(key);
+      vector(value);
+    }
+  }
+
+  void model(const SharedDiagonal& model) {
+    if (!model) {
+      pod(kNoModel);
+    } else if (auto unit = std::dynamic_pointer_cast<noiseModel::Unit>(model)) {
+      pod(kUnit);
+      pod<uint64_t>(unit->dim());
+    } else if (auto isotropic =
+                   std::dynamic_pointer_cast<noiseModel::Isotropic>(model)) {
+      pod(kIsotropic);
+      pod<uint64_t>(isotropic->dim());
+      pod<double>(isotropic->sigma());
+    } else if (auto constrained =
+                   std::dynamic_pointer_cast<noiseModel::Constrained>(model)) {
+      pod(kConstrained);
+      vector(constrained->mu());
+      vector(constrained->sigmas());
+    } else {
+      pod(kDiagonal);
+      vector(model->sigmas());
+    }
+  }
+
+  /// A Jacobian or Hessian factor, or a conditional as a Jacobian factor
+  void factor(const GaussianFactor::shared_ptr& factor) {
+    if (!factor) {
+      pod(kNullFactor);
+    } else if (auto jacobian =
+                   std::dynamic_pointer_cast<JacobianFactor>(factor)) {
+      pod(kJacobianFactor);
+      keys(jacobian->keys());
+      std::vector<uint64_t> dims;
+      for (auto it = jacobian->begin(); it != jacobian->end(); ++it)
+        dims.push_back(jacobian->getDim(it));
+      array(dims.data(), dims.size());
+      matrix(jacobian->matrixObject().full());
+      model(jacobian->get_model());
+    } else if (auto hessian =
+                   std::dynamic_pointer_cast<HessianFactor>(factor)) {
+      pod(kHessianFactor);
+      keys(hessian->keys());
+      std::vector<uint64_t> dims;
+      for (auto it = hessian->begin(); it != hessian->end(); ++it)
+        dims.push_back(hessian->getDim(it));
+      array(dims.data(), dims.size());
+      matrix(hessian->info().selfadjointView());
+    } else {
+      throw std::invalid_argument(
+          "ISAM2::saveCheckpoint: only Jacobian and Hessian factors are "
+          "supported");
+    }
+  }
+};
+
+/// Reads what Writer wrote from a contiguous buffer, checking its bounds
+class Reader {
+  const char* data_;
+  const char* end_;
+
+  void take(void* out, size_t bytes) {
+    if (bytes > size_t(end_ - data_))
+      throw std::runtime_error("ISAM2::loadCheckpoint: truncated checkpoint");
+    std::memcpy(out, data_, bytes);
+    data_ += bytes;
+  }
+
+ public:
+  Reader(const char* data, size_t size) : data_(data), end_(data + size) {}
+
+  bool atEnd() const { return data_ == end_; }
+
+  template <typename T>
+  T pod() {
+    T value;
+    take(&value, sizeof(T));
+    return value;
+  }
+
+  /// Size of the next array, which must fit in the remaining bytes
+  size_t arraySize(size_t elementSize) {
+    const uint64_t n = pod<uint64_t>();
+    if (n > size_t(end_ - data_) / elementSize)
+      throw std::runtime_error("ISAM2::loadCheckpoint: truncated checkpoint");
+    return n;
+  }
+
+  template <typename T>
+  std::vector<T> array() {
+    std::vector<T> result(arraySize(sizeof(T)));
+    take(result.data(), result.size() * sizeof(T));
+    return result;
+  }
+
+  KeyVector keys() {
+    const std::vector<Key> flat = array<Key>();
+    return KeyVector(flat.begin(), flat.end());
+  }
+
+  Vector vector() {
+    Vector v(arraySize(sizeof(double)));
+    take(v.data(), v.size() * sizeof(double));
+    return v;
+  }
+
+  Matrix matrix() {
+    const uint64_t rows = pod<uint64_t>();
+    const size_t size = arraySize(sizeof(double));
+    if (rows == 0 ? size != 0 : size % rows != 0)
+      throw std::runtime_error("ISAM2::loadCheckpoint: corrupt matrix");
+    Matrix m(rows, rows == 0 ? 0 : size / rows);
+    take(m.data(), size * sizeof(double));
+    return m;
+  }
+
+  VectorValues vectorValues() {
+    VectorValues values;
+    const uint64_t n = pod<uint64_t>();
+    for (uint64_t i = 0; i < n; ++i) {
+      const Key key = pod<Key>();
+      values.insert(key, vector());
+    }
+    return values;
+  }
+
+  SharedDiagonal model() {
+    switch (pod<ModelTag>()) {
+      case kNoModel:
+        return SharedDiagonal();
+      case kUnit:
+        return noiseModel::Unit::Create(pod<uint64_t>());
+      case kIsotropic: {
+        const uint64_t dim = pod<uint64_t>();
+        return noiseModel::Isotropic::Sigma(dim, pod<double>());
+      }
+      case kDiagonal:
+        return noiseModel::Diagonal::Sigmas(vector(), false);
+      case kConstrained: {
+        const Vector mu = vector();
+        return noiseModel::Constrained::MixedSigmas(mu, vector());
+      }
+    }
+    throw std::runtime_error("ISAM2::loadCheckpoint: unknown noise model");
+  }
+
+  /// Keys, dimensions and augmented matrix of a factor
+  void factorData(KeyVector* keys, std::vector<uint64_t>* dims, Matrix* m) {
+    *keys = this->keys();
+    *dims = array<uint64_t>();
+    *m = matrix();
+    if (dims->size() != keys->size())
+      throw std::runtime_error("ISAM2::loadCheckpoint: corrupt factor");
+  }
+
+  GaussianFactor::shared_ptr factor() {
+    KeyVector keys;
+    std::vector<uint64_t> dims;
+    Matrix m;
+    switch (pod<FactorTag>()) {
+      case kNullFactor:
+        return nullptr;
+      case kJacobianFactor: {
+        factorData(&keys, &dims, &m);
+        const VerticalBlockMatrix Ab(dims, m, true);
+        return std::make_shared<JacobianFactor>(keys, Ab, model());
+      }
+      case kHessianFactor:
+        factorData(&keys, &dims, &m);
+        return std::make_shared<HessianFactor>(
+            keys, SymmetricBlockMatrix(dims, m, true));
+    }
+    throw std::runtime_error("ISAM2::loadCheckpoint: unknown factor type");
+  }
+
+  GaussianConditional::shared_ptr conditional() {
+    const uint64_t nrFrontals = pod<uint64_t>();
+    if (pod<FactorTag>() != kJacobianFactor)
+      throw std::runtime_error("ISAM2::loadCheckpoint: corrupt conditional");
+    KeyVector keys;
+    std::vector<uint64_t> dims;
+    Matrix m;
+    factorData(&keys, &dims, &m);
+    const VerticalBlockMatrix Ab(dims, m, true);
+    return std::make_shared<GaussianConditional>(keys, nrFrontals, Ab,
+                                                 model());
+  }
+};
+
+}  // namespace
+
+/* ************************************************************************* */
+void ISAM2::saveCheckpoint(std::ostream& os) const {
+  gttic(ISAM2_saveCheckpoint);
+  Writer writer(os);
+  os.write(kMagic, sizeof(kMagic));
+  writer.pod(kVersion);
+  writer.pod(kByteOrder);
+
+  // The nonlinear part is polymorphic, and stored in Boost binary archives
+  const std::string theta = serializeBinary(theta_);
+  writer.array(theta.data(), theta.size());
+  const std::string nonlinearFactors = serializeBinary(nonlinearFactors_);
+  writer.array(nonlinearFactors.data(), nonlinearFactors.size());
+
+  // Cliques, parents first, each with the index of its parent
+  std::vector<std::pair<sharedClique, int64_t>> stack;
+  for (const sharedClique& root : roots_) stack.emplace_back(root, -1);
+  std::vector<std::pair<sharedClique, int64_t>> cliques;
+  while (!stack.empty()) {
+    auto entry = std::move(stack.back());
+    stack.pop_back();
+    const int64_t index = cliques.size();
+    for (const sharedClique& child : entry.first->children)
+      stack.emplace_back(child, index);
+    cliques.push_back(std::move(entry));
+  }
+  writer.pod<uint64_t>(cliques.size());
+  for (const auto& [clique, parent] : cliques) {
+    writer.pod(parent);
+    writer.pod<uint64_t>(clique->conditional()->nrFrontals());
+    writer.factor(clique->conditional());
+    writer.factor(clique->cachedFactor_);
+    writer.vector(clique->gradientContribution_);
+  }
+
+  // Linear state
+  writer.vectorValues(delta_);
+  writer.vectorValues(deltaNewton_);
+  writer.vectorValues(RgProd_);
+  writer.keys(deltaReplacedMask_);
+  writer.pod<uint64_t>(linearFactors_.size());
+  for (const auto& factor : linearFactors_) writer.factor(factor);
+
+  // Bookkeeping
+  writer.pod<uint8_t>(doglegDelta_.has_value());
+  writer.pod<double>(doglegDelta_.value_or(0.0));
+  writer.keys(fixedVariables_);
+  writer.pod<int64_t>(update_count_);
+  writer.pod<uint64_t>(lastTouched_.size());
+  for (const auto& [key, touched] : lastTouched_) {
+    writer.pod<Key>(key);
+    writer.pod<int64_t>(touched);
+  }
+  if (!os) throw std::runtime_error("ISAM2::saveCheckpoint: write failed");
+}
+
+/* ************************************************************************* */
+void ISAM2::saveCheckpoint(const std::string& filename) const {
+  std::ofstream os(filename, std::ios::out | std::ios::binary);
+  if (!os)
+    throw std::runtime_error("ISAM2::saveCheckpoint: cannot open " + filename);
+  saveCheckpoint(os);
+}
+
+/* ************************************************************************* */
+void ISAM2::loadCheckpoint(const char* data, size_t size) {
+  gttic(ISAM2_loadCheckpoint);
+  Reader reader(data, size);
+  char magic[sizeof(kMagic)];
+  for (char& c : magic) c = reader.pod<char>();
+  if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+    throw std::runtime_error("ISAM2::loadCheckpoint: not an ISAM2 checkpoint");
+  if (reader.pod<uint32_t>() != kVersion)
+    throw std::runtime_error("ISAM2::loadCheckpoint: unsupported version");
+  if (reader.pod<uint32_t>() != kByteOrder)
+    throw std::runtime_error("ISAM2::loadCheckpoint: different byte order");
+
+  // Everything is read before any member is modified
+  Values theta;
+  NonlinearFactorGraph nonlinearFactors;
+  {
+    std::vector<char> archive = reader.array<char>();
+    deserializeBinary(std::string(archive.begin(), archive.end()), theta);
+    archive = reader.array<char>();
+    deserializeBinary(std::string(archive.begin(), archive.end()),
+                      nonlinearFactors);
+  }
+
+  const uint64_t nrCliques = reader.pod<uint64_t>();
+  std::vector<std::pair<sharedClique, int64_t>> cliques;
+  for (uint64_t i = 0; i < nrCliques; ++i) {
+    const int64_t parent = reader.pod<int64_t>();
+    if (parent >= int64_t(i))
+      throw std::runtime_error("ISAM2::loadCheckpoint: corrupt Bayes tree");
+    auto clique = std::make_shared<Clique>();
+    GaussianConditional::shared_ptr conditional = reader.conditional();
+    clique->setEliminationResult({conditional, reader.factor()});
+    clique->gradientContribution_ = reader.vector();
+    cliques.emplace_back(clique, parent);
+  }
+
+  VectorValues delta = reader.vectorValues();
+  VectorValues deltaNewton = reader.vectorValues();
+  VectorValues RgProd = reader.vectorValues();
+  const KeyVector deltaReplacedMask = reader.keys();
+  GaussianFactorGraph linearFactors;
+  const uint64_t nrLinearFactors = reader.pod<uint64_t>();
+  linearFactors.reserve(nrLinearFactors);
+  for (uint64_t i = 0; i < nrLinearFactors; ++i)
+    linearFactors.push_back(reader.factor());
+
+  const bool hasDoglegDelta = reader.pod<uint8_t>();
+  const double doglegDelta = reader.pod<double>();
+  const KeyVector fixedVariables = reader.keys();
+  const int64_t updateCount = reader.pod<int64_t>();
+  FastMap<Key, int> lastTouched;
+  const uint64_t nrTouched = reader.pod<uint64_t>();
+  for (uint64_t i = 0; i < nrTouched; ++i) {
+    const Key key = reader.pod<Key>();
+    lastTouched.emplace(key, reader.pod<int64_t>());
+  }
+  if (!reader.atEnd())
+    throw std::runtime_error("ISAM2::loadCheckpoint: trailing data");
+
+  // Replace the state
+  Base::clear();
+  for (const auto& [clique, parent] : cliques)
+    addClique(clique, parent < 0 ? sharedClique() : cliques[parent].first);
+  theta_ = std::move(theta);
+  nonlinearFactors_ = std::move(nonlinearFactors);
+  variableIndex_ = VariableIndex(nonlinearFactors_);
+  delta_ = std::move(delta);
+  deltaNewton_ = std::move(deltaNewton);
+  RgProd_ = std::move(RgProd);
+  deltaReplacedMask_ = KeySet(deltaReplacedMask.begin(), deltaReplacedMask.end());
+  linearFactors_ = std::move(linearFactors);
+  doglegDelta_.reset();
+  if (hasDoglegDelta) doglegDelta_ = doglegDelta;
+  fixedVariables_ = KeySet(fixedVariables.begin(), fixedVariables.end());
+  update_count_ = updateCount;
+  lastTouched_ = std::move(lastTouched);
+  covariances_ = BayesTreeCovariances<ISAM2Clique>();
+  covariancesStale_ = true;
+  recountMemoryUsage();
+}
+
+/* ************************************************************************* */
+void ISAM2::loadCheckpoint(const std::string& filename) {
+  std::ifstream is(filename, std::ios::in | std::ios::binary);
+  if (!is)
+    throw std::runtime_error("ISAM2::loadCheckpoint: cannot open " + filename);
+  const std::vector<char> data((std::istreambuf_iterator<char>(is)),
+                               std::istreambuf_iterator<char>());
+  loadCheckpoint(data.data(), data.size());
+}
+
+}  // namespace gtsam
+
+#endif
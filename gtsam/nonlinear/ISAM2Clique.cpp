@@ -18,8 +18,10 @@
 #include <gtsam/inference/BayesTreeCliqueBase-inst.h>
 #include <gtsam/linear/VectorValues.h>
 #include <gtsam/linear/linearAlgorithms-inst.h>
+#include <gtsam/linear/linearExceptions.h>
 #include <gtsam/nonlinear/ISAM2Clique.h>
 
+#include <algorithm>
 #include <stack>
 #include <utility>
 
@@ -35,6 +37,7 @@ void ISAM2Clique::setEliminationResult(
     const FactorGraphType::EliminationResult& eliminationResult) {
   conditional_ = eliminationResult.first;
   cachedFactor_ = eliminationResult.second;
+  deltaReplaced_ = true;
   // Compute gradient contribution
   gradientContribution_.resize(conditional_->cols() - 1);
   // Rewrite -(R * P')'*d   as   -(d' * R * P')'   for computational speed
@@ -64,203 +67,174 @@ void ISAM2Clique::print(const string& s, const KeyFormatter& formatter) const {
 }
 
 /* ************************************************************************* */
-bool ISAM2Clique::isDirty(const KeySet& replaced, const KeySet& changed) const {
-  // if none of the variables in this clique (frontal and separator!) changed
-  // significantly, then by the running intersection property, none of the
-  // cliques in the children need to be processed
+namespace {
+/**
+ * Solve the diagonal block of R at position for the frontal variable there,
+ * in place in x, given the solution of the frontal variables after it. N is
+ * the dimension of the variable, fixed at compile time for the common sizes
+ * so that Eigen unrolls the products and the triangular solve.
+ */
+template <int N, class RMATRIX>
+void solveFrontal(const RMATRIX& R, DenseIndex position, DenseIndex dim,
+                  Eigen::Ref<Vector> x) {
+  const DenseIndex rest = x.size() - position - dim;
+  auto xj = x.template segment<N>(position, dim);
+  if (rest > 0)
+    xj.noalias() -=
+        R.template block<N, Eigen::Dynamic>(position, position + dim, dim, rest) *
+        x.tail(rest);
+  R.template block<N, N>(position, position, dim, dim)
+      .template triangularView<Eigen::Upper>()
+      .solveInPlace(xj);
+}
 
-  // Are any clique variables part of the tree that has been redone?
-  bool dirty = replaced.exists(conditional_->frontals().front());
-#if !defined(NDEBUG) && defined(GTSAM_EXTRA_CONSISTENCY_CHECKS)
-  for (Key frontal : conditional_->frontals()) {
-    assert(dirty == replaced.exists(frontal));
-  }
-#endif
-
-  // If not, then has one of the separator variables changed significantly?
-  if (!dirty) {
-    for (Key parent : conditional_->parents()) {
-      if (changed.exists(parent)) {
-        dirty = true;
-        break;
-      }
-    }
+/// Dispatch on the dimension of one frontal variable: 3, 6, 9 and 15 cover
+/// points, poses, NavStates and NavState+bias blocks
+template <class RMATRIX>
+void solveFrontal(const RMATRIX& R, DenseIndex position, DenseIndex dim,
+                  Eigen::Ref<Vector> x) {
+  switch (dim) {
+    case 3:
+      return solveFrontal<3>(R, position, dim, x);
+    case 6:
+      return solveFrontal<6>(R, position, dim, x);
+    case 9:
+      return solveFrontal<9>(R, position, dim, x);
+    case 15:
+      return solveFrontal<15>(R, position, dim, x);
+    default:
+      return solveFrontal<Eigen::Dynamic>(R, position, dim, x);
   }
-  return dirty;
 }
 
-/* ************************************************************************* */
 /**
- * Back-substitute - special version stores solution pointers in cliques for
- * fast access.
+ * Solve R x = d - S x_S for the frontal variables of a conditional, with the
+ * separator taken from delta, and write x into delta if the clique was
+ * replaced or if x moved by at least threshold. Returns whether it did. R is
+ * solved one frontal variable at a time, from the last, so that each block
+ * gets the fixed-size kernel for its own dimension whatever the other
+ * frontals are. x lives in a per-thread buffer.
  */
-void ISAM2Clique::fastBackSubstitute(VectorValues* delta) const {
-#ifdef USE_BROKEN_FAST_BACKSUBSTITUTE
-  // TODO(gareth): This code shares a lot of logic w/ linearAlgorithms-inst,
-  // potentially refactor
-
-  // Create solution part pointers if necessary and possible - necessary if
-  // solnPointers_ is empty, and possible if either we're a root, or we have
-  // a parent with valid solnPointers_.
-  ISAM2Clique::shared_ptr parent = parent_.lock();
-  if (solnPointers_.empty() && (isRoot() || !parent->solnPointers_.empty())) {
-    for (Key frontal : conditional_->frontals())
-      solnPointers_.emplace(frontal, delta->find(frontal));
-    for (Key parentKey : conditional_->parents()) {
-      assert(parent->solnPointers_.exists(parentKey));
-      solnPointers_.emplace(parentKey, parent->solnPointers_.at(parentKey));
-    }
+bool backSubstitute(const GaussianConditional& c, bool replaced,
+                    double threshold, VectorValues* delta) {
+  const DenseIndex n = c.R().rows();
+  static thread_local Vector buffer;
+  if (buffer.size() < n) buffer.resize(n);
+  auto x = buffer.head(n);
+  x = c.getb();
+  for (auto parent = c.beginParents(); parent != c.endParents(); ++parent)
+    x.noalias() -= c.getA(parent) * delta->at(*parent);
+
+  DenseIndex position = n;
+  for (auto frontal = c.endFrontals(); frontal != c.beginFrontals();) {
+    --frontal;
+    const DenseIndex dim = c.getDim(frontal);
+    position -= dim;
+    solveFrontal(c.R(), position, dim, x);
   }
 
-  // See if we can use solution part pointers - we can if they either
-  // already existed or were created above.
-  if (!solnPointers_.empty()) {
-    GaussianConditional& c = *conditional_;
-    // Solve matrix
-    Vector xS;
-    {
-      // Count dimensions of vector
-      DenseIndex dim = 0;
-      FastVector<VectorValues::const_iterator> parentPointers;
-      parentPointers.reserve(conditional_->nrParents());
-      for (Key parent : conditional_->parents()) {
-        parentPointers.push_back(solnPointers_.at(parent));
-        dim += parentPointers.back()->second.size();
-      }
-
-      // Fill parent vector
-      xS.resize(dim);
-      DenseIndex vectorPos = 0;
-      for (const VectorValues::const_iterator& parentPointer : parentPointers) {
-        const Vector& parentVector = parentPointer->second;
-        xS.block(vectorPos, 0, parentVector.size(), 1) =
-            parentVector.block(0, 0, parentVector.size(), 1);
-        vectorPos += parentVector.size();
-      }
-    }
+  // Check for indeterminant solution
+  if (x.hasNaN()) throw IndeterminantLinearSystemException(c.front());
+
+  // Compare against the previous values, unless the clique was replaced
+  bool changed = replaced;
+  position = 0;
+  for (auto frontal = c.beginFrontals(); !changed && frontal != c.endFrontals();
+       ++frontal) {
+    const DenseIndex dim = c.getDim(frontal);
+    changed = (x.segment(position, dim) - delta->at(*frontal))
+                  .template lpNorm<Eigen::Infinity>() >= threshold;
+    position += dim;
+  }
 
-    // NOTE(gareth): We can no longer write: xS = b - S * xS
-    // This is because Eigen (as of 3.3) no longer evaluates S * xS into
-    // a temporary, and the operation trashes valus in xS.
-    // See: http://eigen.tuxfamily.org/index.php?title=3.3
-    const Vector rhs = c.getb() - c.S() * xS;
-    const Vector solution = c.R().triangularView<Eigen::Upper>().solve(rhs);
-
-    // Check for indeterminant solution
-    if (solution.hasNaN())
-      throw IndeterminantLinearSystemException(c.keys().front());
-
-    // Insert solution into a VectorValues
-    DenseIndex vectorPosition = 0;
-    for (GaussianConditional::const_iterator frontal = c.beginFrontals();
-         frontal != c.endFrontals(); ++frontal) {
-      solnPointers_.at(*frontal)->second =
-          solution.segment(vectorPosition, c.getDim(frontal));
-      vectorPosition += c.getDim(frontal);
+  if (changed) {
+    position = 0;
+    for (auto frontal = c.beginFrontals(); frontal != c.endFrontals();
+         ++frontal) {
+      const DenseIndex dim = c.getDim(frontal);
+      delta->at(*frontal) = x.segment(position, dim);
+      position += dim;
     }
-  } else {
-    // Just call plain solve because we couldn't use solution pointers.
-    delta->update(conditional_->solve(*delta));
   }
-#else
-  delta->update(conditional_->solve(*delta));
-#endif
-}
-
-/* ************************************************************************* */
-bool ISAM2Clique::valuesChanged(const KeySet& replaced,
-                                const Vector& originalValues,
-                                const VectorValues& delta,
-                                double threshold) const {
-  auto frontals = conditional_->frontals();
-  if (replaced.exists(frontals.front())) return true;
-  Vector diff = originalValues - delta.vector(frontals);
-  return diff.lpNorm<Eigen::Infinity>() >= threshold;
+  return changed;
 }
+}  // namespace
 
 /* ************************************************************************* */
-/// Set changed flag for each frontal variable
-void ISAM2Clique::markFrontalsAsChanged(KeySet* changed) const {
-  for (Key frontal : conditional_->frontals()) {
-    changed->insert(frontal);
+bool ISAM2Clique::separatorChanged() const {
+  const size_t nrFrontals = conditional_->nrFrontals();
+  const size_t nrParents = conditional_->nrParents();
+  deltaChanged_.assign(nrFrontals + nrParents, false);
+
+  const ISAM2Clique::shared_ptr parent = parent_.lock();
+  if (!parent || nrParents == 0) return false;
+
+  // By the running intersection property every separator variable is either a
+  // frontal or a separator variable of the parent. Its position there is
+  // cached, and only searched for again if the parent changed.
+  const KeyVector& parentKeys = parent->conditional_->keys();
+  const std::vector<bool>& parentChanged = parent->deltaChanged_;
+  parentSlots_.resize(nrParents, 0);
+  bool changed = false;
+  for (size_t i = 0; i < nrParents; ++i) {
+    const Key key = conditional_->keys()[nrFrontals + i];
+    size_t& slot = parentSlots_[i];
+    if (slot >= parentKeys.size() || parentKeys[slot] != key)
+      slot = std::find(parentKeys.begin(), parentKeys.end(), key) -
+             parentKeys.begin();
+    if (slot < parentChanged.size() && parentChanged[slot]) {
+      deltaChanged_[nrFrontals + i] = true;
+      changed = true;
+    }
   }
+  return changed;
 }
 
 /* ************************************************************************* */
-void ISAM2Clique::restoreFromOriginals(const Vector& originalValues,
-                                       VectorValues* delta) const {
-  size_t pos = 0;
-  for (Key frontal : conditional_->frontals()) {
-    auto v = delta->at(frontal);
-    v = originalValues.segment(pos, v.size());
-    pos += v.size();
-  }
+void ISAM2Clique::optimizeInPlace(VectorValues* delta) const {
+  backSubstitute(*conditional_, true, 0.0, delta);
+  deltaReplaced_ = false;
 }
 
 /* ************************************************************************* */
 // Note: not being used right now in favor of non-recursive version below.
-void ISAM2Clique::optimizeWildfire(const KeySet& replaced, double threshold,
-                                   KeySet* changed, VectorValues* delta,
+void ISAM2Clique::optimizeWildfire(double threshold, VectorValues* delta,
                                    size_t* count) const {
-  if (isDirty(replaced, *changed)) {
-    // Temporary copy of the original values, to check how much they change
-    auto originalValues = delta->vector(conditional_->frontals());
-
-    // Back-substitute
-    fastBackSubstitute(delta);
-    count += conditional_->nrFrontals();
-
-    if (valuesChanged(replaced, originalValues, *delta, threshold)) {
-      markFrontalsAsChanged(changed);
-    } else {
-      restoreFromOriginals(originalValues, delta);
-    }
-
+  if (optimizeWildfireNode(threshold, delta, count)) {
     // Recurse to children
     for (const auto& child : children) {
-      child->optimizeWildfire(replaced, threshold, changed, delta, count);
+      child->optimizeWildfire(threshold, delta, count);
     }
   }
 }
 
 size_t optimizeWildfire(const ISAM2Clique::shared_ptr& root, double threshold,
-                        const KeySet& keys, VectorValues* delta) {
-  KeySet changed;
+                        VectorValues* delta) {
   size_t count = 0;
   // starting from the root, call optimize on each conditional
-  if (root) root->optimizeWildfire(keys, threshold, &changed, delta, &count);
+  if (root) root->optimizeWildfire(threshold, delta, &count);
   return count;
 }
 
 /* ************************************************************************* */
-bool ISAM2Clique::optimizeWildfireNode(const KeySet& replaced, double threshold,
-                                       KeySet* changed, VectorValues* delta,
+bool ISAM2Clique::optimizeWildfireNode(double threshold, VectorValues* delta,
                                        size_t* count) const {
-  // TODO(gareth): This code shares a lot of logic w/ linearAlgorithms-inst,
-  // potentially refactor
-  bool dirty = isDirty(replaced, *changed);
+  // if none of the variables in this clique (frontal and separator!) changed
+  // significantly, then by the running intersection property, none of the
+  // cliques in the children need to be processed
+  const bool dirty = separatorChanged() || deltaReplaced_;
   if (dirty) {
-    // Temporary copy of the original values, to check how much they change
-    auto originalValues = delta->vector(conditional_->frontals());
-
-    // Back-substitute
-    fastBackSubstitute(delta);
+    // Back-substitute, and mark the frontals if their new values were written
+    if (backSubstitute(*conditional_, deltaReplaced_, threshold, delta))
+      std::fill_n(deltaChanged_.begin(), conditional_->nrFrontals(), true);
+    deltaReplaced_ = false;
     *count += conditional_->nrFrontals();
-
-    if (valuesChanged(replaced, originalValues, *delta, threshold)) {
-      markFrontalsAsChanged(changed);
-    } else {
-      restoreFromOriginals(originalValues, delta);
-    }
   }
-
   return dirty;
 }
 
 size_t optimizeWildfireNonRecursive(const ISAM2Clique::shared_ptr& root,
-                                    double threshold, const KeySet& keys,
-                                    VectorValues* delta) {
-  KeySet changed;
+                                    double threshold, VectorValues* delta) {
   size_t count = 0;
 
   if (root) {
@@ -270,8 +244,7 @@ size_t optimizeWildfireNonRecursive(const ISAM2Clique::shared_ptr& root,
     while (!travStack.empty()) {
       currentNode = travStack.top();
       travStack.pop();
-      bool dirty = currentNode->optimizeWildfireNode(keys, threshold, &changed,
-                                                     delta, &count);
+      bool dirty = currentNode->optimizeWildfireNode(threshold, delta, &count);
       if (dirty) {
         for (const auto& child : currentNode->children) {
           travStack.push(child);
@@ -25,6 +25,7 @@
 #include <gtsam/linear/GaussianConditional.h>
 #include <gtsam/linear/GaussianFactorGraph.h>
 #include <string>
+#include <vector>
 
 namespace gtsam {
 
@@ -45,26 +46,35 @@ class GTSAM_EXPORT ISAM2Clique
 
   Base::FactorType::shared_ptr cachedFactor_;
   Vector gradientContribution_;
-#ifdef USE_BROKEN_FAST_BACKSUBSTITUTE
-  mutable FastMap<Key, VectorValues::iterator> solnPointers_;
-#endif
 
+ private:
+  /// Whether the clique was (re-)eliminated since the last back-substitution
+  /// into delta, i.e., it is part of the top of the tree that has been redone
+  mutable bool deltaReplaced_ = true;
+
+  /// Scratch state of the last wildfire pass: one bit per conditional key,
+  /// frontals then separator, set if its delta changed significantly, and the
+  /// position of each separator key among the keys of the parent
+  mutable std::vector<bool> deltaChanged_;
+  mutable FastVector<size_t> parentSlots_;
+
+ public:
   /// Default constructor
   ISAM2Clique() : Base() {}
 
-  /// Copy constructor, does *not* copy solution pointers as these are invalid
-  /// in different trees.
+  /// Copy constructor, does *not* copy the wildfire scratch state
   ISAM2Clique(const ISAM2Clique& other)
       : Base(other),
         cachedFactor_(other.cachedFactor_),
-        gradientContribution_(other.gradientContribution_) {}
+        gradientContribution_(other.gradientContribution_),
+        deltaReplaced_(other.deltaReplaced_) {}
 
-  /// Assignment operator, does *not* copy solution pointers as these are
-  /// invalid in different trees.
+  /// Assignment operator, does *not* copy the wildfire scratch state
   ISAM2Clique& operator=(const ISAM2Clique& other) {
     Base::operator=(other);
     cachedFactor_ = other.cachedFactor_;
     gradientContribution_ = other.gradientContribution_;
+    deltaReplaced_ = other.deltaReplaced_;
     return *this;
   }
 
@@ -73,6 +83,9 @@ class GTSAM_EXPORT ISAM2Clique
       const FactorGraphType::EliminationResult& eliminationResult);
 
   /** Access the cached factor */
+  const Base::FactorType::shared_ptr& cachedFactor() const {
+    return cachedFactor_;
+  }
   Base::FactorType::shared_ptr& cachedFactor() { return cachedFactor_; }
 
   /// Access the gradient contribution
@@ -87,12 +100,24 @@ class GTSAM_EXPORT ISAM2Clique
   void print(const std::string& s = "",
              const KeyFormatter& formatter = DefaultKeyFormatter) const override;
 
-  void optimizeWildfire(const KeySet& replaced, double threshold,
-                        KeySet* changed, VectorValues* delta,
+  /// Whether the clique was replaced and not yet back-substituted into delta
+  bool deltaReplaced() const { return deltaReplaced_; }
+
+  /// Back-substitute the frontal variables into \c delta, given the separator
+  void optimizeInPlace(VectorValues* delta) const;
+
+  void optimizeWildfire(double threshold, VectorValues* delta,
                         size_t* count) const;
 
-  bool optimizeWildfireNode(const KeySet& replaced, double threshold,
-                            KeySet* changed, VectorValues* delta,
+  /**
+   * Wildfire back-substitution of this clique only. The clique is dirty if it
+   * was replaced, or if a separator variable changed significantly in the
+   * parent, which must have been processed before in the same pass. A dirty
+   * clique is solved, and its frontal variables are written into \c delta if
+   * it was replaced or if they moved by at least \c threshold.
+   * @return whether the clique was dirty, i.e., whether to visit its children
+   */
+  bool optimizeWildfireNode(double threshold, VectorValues* delta,
                             size_t* count) const;
 
   /**
@@ -121,30 +146,10 @@ class GTSAM_EXPORT ISAM2Clique
 
  private:
   /**
-   * Check if clique was replaced, or if any parents were changed above the
-   * threshold or themselves replaced.
-   */
-  bool isDirty(const KeySet& replaced, const KeySet& changed) const;
-
-  /**
-   * Back-substitute - special version stores solution pointers in cliques for
-   * fast access.
+   * Reset deltaChanged_ and copy the bits of the separator variables from the
+   * parent. Returns whether any separator variable changed.
    */
-  void fastBackSubstitute(VectorValues* delta) const;
-
-  /*
-   * Check whether the values changed above a threshold, or always true if the
-   * clique was replaced.
-   */
-  bool valuesChanged(const KeySet& replaced, const Vector& originalValues,
-                     const VectorValues& delta, double threshold) const;
-
-  /// Set changed flag for each frontal variable
-  void markFrontalsAsChanged(KeySet* changed) const;
-
-  /// Restore delta to original values, guided by frontal keys.
-  void restoreFromOriginals(const Vector& originalValues,
-                            VectorValues* delta) const;
+  bool separatorChanged() const;
 
 #ifdef GTSAM_ENABLE_BOOST_SERIALIZATION
   /** Serialization function */
@@ -163,17 +168,15 @@ class GTSAM_EXPORT ISAM2Clique
  * @param threshold The maximum change against the PREVIOUS delta for
  * non-replaced variables that can be ignored, ie. the old delta entry is kept
  * and recursive backsubstitution might eventually stop if none of the changed
- * variables are contained in the subtree.
- * @param replaced Needs to contain all variables that are contained in the top
- * of the Bayes tree that has been redone.
+ * variables are contained in the subtree. The cliques in the top of the Bayes
+ * tree that has been redone are those flagged with deltaReplaced().
  * @return The number of variables that were solved for.
  * @param delta The current solution, an offset from the linearization point.
  */
 size_t optimizeWildfire(const ISAM2Clique::shared_ptr& root, double threshold,
-                        const KeySet& replaced, VectorValues* delta);
+                        VectorValues* delta);
 
 size_t optimizeWildfireNonRecursive(const ISAM2Clique::shared_ptr& root,
-                                    double threshold, const KeySet& replaced,
-                                    VectorValues* delta);
+                                    double threshold, VectorValues* delta);
 
 }  // namespace gtsam
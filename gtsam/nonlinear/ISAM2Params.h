@@ -22,6 +22,7 @@
 #include <gtsam/linear/GaussianFactorGraph.h>
 #include <gtsam/nonlinear/DoglegOptimizerImpl.h>
 
+#include <optional>
 #include <string>
 #include <variant>
 
@@ -224,6 +225,34 @@ struct GTSAM_EXPORT ISAM2Params {
   /// cost of having to search for slots every time a factor is added.
   bool findUnusedFactorSlots;
 
+  /** Memory limits (default: none). When any of these is set, update() ends
+   * by marginalizing the least recently touched leaf cliques of the Bayes tree
+   * with ISAM2::marginalizeLeaves(), until the system is within all limits.
+   * A variable is touched by an update that adds it or adds a factor on it,
+   * and variables touched by the current update are never marginalized, so
+   * the limits may be exceeded if they are too small for a single update; this
+   * is reported by ISAM2Result::withinMemoryLimits.
+   * Marginalized variables are reported in ISAM2Result::marginalizedKeys, and
+   * the size of the system in ISAM2Result::memory. As with marginalizeLeaves,
+   * the variables involved in the resulting marginal factors keep their
+   * linearization points. Enabling findUnusedFactorSlots is recommended so
+   * that the factor slots freed by marginalization are reused.
+   */
+  std::optional<size_t> maxVariables;
+  std::optional<size_t> maxFactors;  ///< See maxVariables
+  std::optional<size_t> maxBytes;    ///< See maxVariables, and
+                                     ///< ISAM2MemoryUsage::bytes
+
+  /** Compact the factor slots when more than this fraction of them is empty
+   * (default: none). Removed and marginalized factors leave empty slots in the
+   * factor graph, unless findUnusedFactorSlots reuses them. When set, update()
+   * ends by calling ISAM2::compactFactors() once the fraction of empty slots
+   * exceeds this value, which renumbers the factors. The renumbering is
+   * reported in ISAM2Result::factorIndexMap, and must be applied to any factor
+   * index kept by the caller.
+   */
+  std::optional<double> compactionThreshold;
+
   /**
    * Specify parameters as constructor arguments
    * See the documentation of member variables above.
@@ -290,6 +319,23 @@ struct GTSAM_EXPORT ISAM2Params {
          << enablePartialRelinearizationCheck << "\n";
     cout << "findUnusedFactorSlots:             " << findUnusedFactorSlots
          << "\n";
+    auto printLimit = [](const std::optional<size_t>& limit) {
+      if (limit)
+        cout << *limit << "\n";
+      else
+        cout << "none\n";
+    };
+    cout << "maxVariables:                      ";
+    printLimit(maxVariables);
+    cout << "maxFactors:                        ";
+    printLimit(maxFactors);
+    cout << "maxBytes:                          ";
+    printLimit(maxBytes);
+    cout << "compactionThreshold:               ";
+    if (compactionThreshold)
+      cout << *compactionThreshold << "\n";
+    else
+      cout << "none\n";
     cout.flush();
   }
 
@@ -331,6 +377,11 @@ struct GTSAM_EXPORT ISAM2Params {
   /// @name Some utilities
   /// @{
 
+  /// Whether any of maxVariables, maxFactors or maxBytes is set
+  bool hasMemoryLimits() const {
+    return maxVariables || maxFactors || maxBytes;
+  }
+
   static Factorization factorizationTranslator(const std::string& str);
   static std::string factorizationTranslator(const Factorization& value);
 
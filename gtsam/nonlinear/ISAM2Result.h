@@ -29,6 +29,19 @@
 
 namespace gtsam {
 
+/**
+ * @ingroup isam2
+ * Size of an ISAM2 system, see ISAM2::memoryUsage() and the memory limits in
+ * ISAM2Params.
+ */
+struct ISAM2MemoryUsage {
+  size_t variables = 0;  ///< Number of variables
+  size_t factors = 0;    ///< Number of nonlinear factors, excluding empty slots
+  size_t bytes = 0;  ///< Estimated storage of the numerical data: the Bayes
+                     ///< tree, the cached linear factors, and the per-variable
+                     ///< vectors. The nonlinear factors are not included.
+};
+
 /**
  * @ingroup isam2
  * This struct is returned from ISAM2::update() and contains information about
@@ -108,6 +121,37 @@ struct ISAM2Result {
   /** All keys that were marked during the update process. */
   KeySet markedKeys;
 
+  /** Keys of variables above the relinearization threshold that were not
+   * relinearized because of ISAM2UpdateParams::maxReeliminationCost, and are
+   * left for later updates. */
+  KeySet deferredRelinKeys;
+
+  /** Estimated flops of re-elimination that deferring deferredRelinKeys
+   * saved in this update. */
+  double deferredCost = 0.0;
+
+  /** Keys of the variables marginalized at the end of the update to stay
+   * within the memory limits of ISAM2Params, least recently touched first. */
+  KeyVector marginalizedKeys;
+
+  /** False if memory limits are set in ISAM2Params and the system still
+   * exceeds them after the update, because every remaining leaf clique was
+   * touched by the update. */
+  bool withinMemoryLimits = true;
+
+  /** The size of the system after the update.
+   * \par Note: This will only be computed if memory limits are set in
+   * ISAM2Params or ISAM2Params::enableDetailedResults is \c true.
+   */
+  std::optional<ISAM2MemoryUsage> memory;
+
+  /** If the factors were compacted at the end of the update, see
+   * ISAM2Params::compactionThreshold, the new index of each factor by its
+   * index before compaction, as returned by ISAM2::compactFactors(). Empty
+   * otherwise. newFactorsIndices are already renumbered.
+   */
+  FactorIndices factorIndexMap;
+
   /**
    * A struct holding detailed results, which must be enabled with
    * ISAM2Params::enableDetailedResults.
@@ -173,14 +217,26 @@ struct ISAM2Result {
     using std::cout;
     cout << str << "  Reelimintated: " << variablesReeliminated
          << "  Relinearized: " << variablesRelinearized
-         << "  Cliques: " << cliques << std::endl;
+         << "  Deferred: " << deferredRelinKeys.size()
+         << "  Cliques: " << cliques;
+    if (!marginalizedKeys.empty())
+      cout << "  Marginalized: " << marginalizedKeys.size();
+    if (!withinMemoryLimits) cout << "  Over memory limits";
+    if (memory)
+      cout << "  Variables: " << memory->variables
+           << "  Factors: " << memory->factors << "  Bytes: " << memory->bytes;
+    cout << std::endl;
   }
 
   /** Getters and Setters */
   size_t getVariablesRelinearized() const { return variablesRelinearized; }
   size_t getVariablesReeliminated() const { return variablesReeliminated; }
+  size_t getVariablesDeferred() const { return deferredRelinKeys.size(); }
+  double getDeferredCost() const { return deferredCost; }
   FactorIndices getNewFactorsIndices() const { return newFactorsIndices; }
   size_t getCliques() const { return cliques; }
+  KeyVector getMarginalizedKeys() const { return marginalizedKeys; }
+  bool isWithinMemoryLimits() const { return withinMemoryLimits; }
   double getErrorBefore() const { return errorBefore ? *errorBefore : std::nan(""); }
   double getErrorAfter() const { return errorAfter ? *errorAfter : std::nan(""); }
 };
@@ -69,6 +69,19 @@ struct ISAM2UpdateParams {
    * the deltas become too small down in the tree. This flagg forces a full
    * solve instead. */
   bool forceFullSolve{false};
+
+  /** An optional budget on the work of this update, in estimated flops to
+   * re-eliminate the top of the Bayes tree. The cost of each clique in the
+   * top is estimated from its frontal and separator dimensions, as for
+   * junction tree clusters. The cliques marked by new and removed factors are
+   * always re-eliminated and count against the budget. If relinearization
+   * would take the total over budget, the variables above the relinearization
+   * threshold with the smallest deltas are deferred until it fits: they keep
+   * their linearization point and stay above threshold, so they are
+   * considered again at the next relinearization step. The deferred keys and
+   * the cost they would have added are reported in
+   * ISAM2Result::deferredRelinKeys and ISAM2Result::deferredCost. */
+  std::optional<double> maxReeliminationCost;
 };
 
 }  // namespace gtsam
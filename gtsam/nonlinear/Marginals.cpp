@@ -20,6 +20,11 @@
 #include <gtsam/linear/JacobianFactor.h>
 #include <gtsam/linear/HessianFactor.h>
 #include <gtsam/nonlinear/Marginals.h>
+#include <gtsam/config.h> // for GTSAM_USE_TBB
+
+#ifdef GTSAM_USE_TBB
+#  include <tbb/parallel_for.h>
+#endif
 
 using namespace std;
 
@@ -134,6 +139,16 @@ Matrix Marginals::marginalCovariance(Key variable) const {
   return marginalInformation(variable).inverse();
 }
 
+/* ************************************************************************* */
+const BayesTreeCovariances<GaussianBayesTreeClique>& Marginals::covariances()
+    const {
+  if (!covariances_)
+    covariances_ =
+        std::make_shared<BayesTreeCovariances<GaussianBayesTreeClique>>(
+            bayesTree_);
+  return *covariances_;
+}
+
 /* ************************************************************************* */
 JointMarginal Marginals::jointMarginalCovariance(const KeyVector& variables) const {
   JointMarginal info = jointMarginalInformation(variables);
@@ -141,6 +156,61 @@ JointMarginal Marginals::jointMarginalCovariance(const KeyVector& variables) con
   return info;
 }
 
+/* ************************************************************************* */
+std::vector<JointMarginal> Marginals::jointMarginalCovariances(
+    const std::vector<KeyVector>& variables) const {
+  gttic(jointMarginalCovariances);
+
+  // Computed before the parallel loop, as the first call is not thread-safe
+  const BayesTreeCovariances<GaussianBayesTreeClique>& cov = covariances();
+
+  std::vector<JointMarginal> result(variables.size());
+  auto computeOne = [&](size_t q) {
+    // Fall back to elimination if any pair does not share a clique
+    const KeyVector& keys = variables[q];
+    for (size_t i = 0; i < keys.size(); ++i) {
+      for (size_t j = i; j < keys.size(); ++j) {
+        if (!cov.exists(keys[i], keys[j])) {
+          result[q] = jointMarginalCovariance(keys);
+          return;
+        }
+      }
+    }
+
+    // Otherwise assemble the blocks, with sorted keys as above
+    KeyVector keysSorted = keys;
+    std::sort(keysSorted.begin(), keysSorted.end());
+    std::vector<size_t> dims, offsets(1, 0);
+    for (Key key : keysSorted) {
+      dims.push_back(values_.at(key).dim());
+      offsets.push_back(offsets.back() + dims.back());
+    }
+    Matrix covariance(offsets.back(), offsets.back());
+    for (size_t i = 0; i < keysSorted.size(); ++i) {
+      for (size_t j = i; j < keysSorted.size(); ++j) {
+        const Matrix block = cov.covariance(keysSorted[i], keysSorted[j]);
+        covariance.block(offsets[i], offsets[j], dims[i], dims[j]) = block;
+        covariance.block(offsets[j], offsets[i], dims[j], dims[i]) =
+            block.transpose();
+      }
+    }
+    result[q] = JointMarginal(covariance, dims, keysSorted);
+  };
+
+#ifdef GTSAM_USE_TBB
+  TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, variables.size()),
+                    [&](const tbb::blocked_range<size_t>& range) {
+                      for (size_t q = range.begin(); q != range.end(); ++q)
+                        computeOne(q);
+                    });
+#else
+  for (size_t q = 0; q < variables.size(); ++q) computeOne(q);
+#endif
+
+  return result;
+}
+
 /* ************************************************************************* */
 JointMarginal Marginals::jointMarginalInformation(const KeyVector& variables) const {
 
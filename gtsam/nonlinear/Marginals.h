@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <gtsam/linear/BayesTreeCovariances.h>
 #include <gtsam/linear/GaussianBayesTree.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
@@ -45,6 +46,8 @@ protected:
   Values values_;
   Factorization factorization_;
   GaussianBayesTree bayesTree_;
+  mutable std::shared_ptr<BayesTreeCovariances<GaussianBayesTreeClique>>
+      covariances_;
 
 public:
 
@@ -116,6 +119,22 @@ public:
   /** Compute the joint marginal covariance of several variables */
   JointMarginal jointMarginalCovariance(const KeyVector& variables) const;
 
+  /** Compute the joint marginal covariances of many small groups of
+   * variables, e.g. the pairs queried by data association, in parallel.
+   * Groups whose variables all share cliques are read from covariances(), the
+   * others are computed as by jointMarginalCovariance(), sharing the separator
+   * marginals cached in the Bayes tree. Returns one JointMarginal per group,
+   * in the same order. */
+  std::vector<JointMarginal> jointMarginalCovariances(
+      const std::vector<KeyVector>& variables) const;
+
+  /** Marginal covariances of all variables, and the covariance blocks of
+   * variables that share a clique, computed in one pass over the Bayes tree on
+   * the first call, see BayesTreeCovariances. Much faster than calling
+   * marginalCovariance() for every variable. The first call is not
+   * thread-safe. */
+  const BayesTreeCovariances<GaussianBayesTreeClique>& covariances() const;
+
   /** Compute the joint marginal information of several variables */
   JointMarginal jointMarginalInformation(const KeyVector& variables) const;
 
@@ -181,6 +181,46 @@ std::shared_ptr<GaussianFactor> NoiseModelFactor::linearize(
   }
 }
 
+/* ************************************************************************* */
+void NoiseModelFactor::linearizeInto(const Values& x,
+                                     GaussianFactor::shared_ptr& result) const {
+  // We can only overwrite a Jacobian that nobody else holds on to, and
+  // constrained models need a per-linearization noise model, so skip those.
+  auto jacobian = dynamic_cast<JacobianFactor*>(result.get());
+  if (!jacobian || result.use_count() != 1 || jacobian->get_model() ||
+      (noiseModel_ && noiseModel_->isConstrained()) ||
+      jacobian->keys() != keys() || !active(x)) {
+    result = linearize(x);
+    return;
+  }
+
+  // Per-thread scratch space for the Jacobians, so in steady state the
+  // matrices are only resized, never reallocated.
+  thread_local std::vector<Matrix> A;
+  A.resize(size());
+  Vector b = -unwhitenedError(x, &A);
+  check(noiseModel_, b.size());
+  if (noiseModel_) noiseModel_->WhitenSystem(A, b);
+
+  // Bail out if the dimensions changed since the previous linearization
+  if (static_cast<size_t>(b.size()) != jacobian->rows()) {
+    result = linearize(x);
+    return;
+  }
+  for (size_t j = 0; j < size(); ++j) {
+    if (A[j].rows() != b.size() ||
+        A[j].cols() != jacobian->getDim(jacobian->begin() + j)) {
+      result = linearize(x);
+      return;
+    }
+  }
+
+  // Overwrite the numeric values in place
+  for (size_t j = 0; j < size(); ++j)
+    jacobian->getA(jacobian->begin() + j) = A[j];
+  jacobian->getb() = b;
+}
+
 /* ************************************************************************* */
 
 } // \namespace gtsam
@@ -144,6 +144,18 @@ public:
   virtual std::shared_ptr<GaussianFactor>
   linearize(const Values& c) const = 0;
 
+  /**
+   * Linearize into an existing GaussianFactor, typically the result of a
+   * previous linearization of this factor. Derived classes can override this
+   * to overwrite the numeric values of \c result in place when it has the
+   * right structure, instead of allocating a new factor. The default
+   * implementation simply replaces \c result with linearize(c).
+   */
+  virtual void linearizeInto(const Values& c,
+                             std::shared_ptr<GaussianFactor>& result) const {
+    result = linearize(c);
+  }
+
   /**
    * Creates a shared_ptr clone of the factor - needs to be specialized to allow
    * for subclasses
@@ -295,6 +307,14 @@ public:
    */
   std::shared_ptr<GaussianFactor> linearize(const Values& x) const override;
 
+  /**
+   * Linearize into \c result, reusing its storage if it is a JacobianFactor
+   * on the same keys and dimensions that is not shared with anyone else.
+   * Otherwise falls back to linearize.
+   */
+  void linearizeInto(const Values& x,
+                     std::shared_ptr<GaussianFactor>& result) const override;
+
   /**
    * Creates a shared_ptr clone of the
    * factor with a new noise model
@@ -31,6 +31,7 @@
 
 #ifdef GTSAM_USE_TBB
 #  include <tbb/parallel_for.h>
+#  include <tbb/parallel_reduce.h>
 #endif
 
 #include <algorithm>
@@ -215,22 +216,65 @@ class _LinearizeOneFactor {
   const NonlinearFactorGraph& nonlinearGraph_;
   const Values& linearizationPoint_;
   GaussianFactorGraph& result_;
+  bool reuse_;
 public:
-  // Create functor with constant parameters
+  // Create functor with constant parameters, if reuse is true the factors are
+  // linearized into the existing entries of result.
   _LinearizeOneFactor(const NonlinearFactorGraph& graph,
-      const Values& linearizationPoint, GaussianFactorGraph& result) :
-      nonlinearGraph_(graph), linearizationPoint_(linearizationPoint), result_(result) {
+      const Values& linearizationPoint, GaussianFactorGraph& result,
+      bool reuse = false) :
+      nonlinearGraph_(graph), linearizationPoint_(linearizationPoint),
+      result_(result), reuse_(reuse) {
   }
   // Operator that linearizes a given range of the factors
   void operator()(const tbb::blocked_range<size_t>& blocked_range) const {
     for (size_t i = blocked_range.begin(); i != blocked_range.end(); ++i) {
-      if (nonlinearGraph_[i] && nonlinearGraph_[i]->sendable())
-        result_[i] = nonlinearGraph_[i]->linearize(linearizationPoint_);
-      else
+      if (nonlinearGraph_[i] && nonlinearGraph_[i]->sendable()) {
+        if (reuse_)
+          nonlinearGraph_[i]->linearizeInto(linearizationPoint_, result_[i]);
+        else
+          result_[i] = nonlinearGraph_[i]->linearize(linearizationPoint_);
+      } else if (!nonlinearGraph_[i]) {
         result_[i] = GaussianFactor::shared_ptr();
+      }
     }
   }
 };
+// Linearizes a range of factors straight into a private Hessian accumulator,
+// which is summed with the accumulators of other threads at the end.
+class _LinearizeIntoHessian {
+  const NonlinearFactorGraph& nonlinearGraph_;
+  const Values& linearizationPoint_;
+  const KeyVector& keys_;
+public:
+  SymmetricBlockMatrix info_;
+  // Create with a zeroed accumulator with the same layout as info
+  _LinearizeIntoHessian(const NonlinearFactorGraph& graph,
+      const Values& linearizationPoint, const KeyVector& keys,
+      const SymmetricBlockMatrix& info) :
+      nonlinearGraph_(graph), linearizationPoint_(linearizationPoint),
+      keys_(keys), info_(info) {
+    info_.setZero();
+  }
+  // Splitting constructor, gets its own zeroed accumulator
+  _LinearizeIntoHessian(_LinearizeIntoHessian& other, tbb::split) :
+      _LinearizeIntoHessian(other.nonlinearGraph_, other.linearizationPoint_,
+                            other.keys_, other.info_) {
+  }
+  // Linearize a range of the factors and add them to the accumulator
+  void operator()(const tbb::blocked_range<size_t>& blocked_range) {
+    for (size_t i = blocked_range.begin(); i != blocked_range.end(); ++i) {
+      const auto& factor = nonlinearGraph_[i];
+      if (factor && factor->sendable())
+        factor->linearize(linearizationPoint_)->updateHessian(keys_, &info_);
+    }
+  }
+  // Sum the accumulator of another thread into ours
+  void join(const _LinearizeIntoHessian& other) {
+    info_.updateFullMatrix(other.info_);
+  }
+};
+
 #endif
 
 }
@@ -277,6 +321,42 @@ GaussianFactorGraph::shared_ptr NonlinearFactorGraph::linearize(const Values& li
   return linearFG;
 }
 
+/* ************************************************************************* */
+void NonlinearFactorGraph::linearizeInto(const Values& linearizationPoint,
+                                         GaussianFactorGraph& result) const {
+  gttic(NonlinearFactorGraph_linearizeInto);
+
+  // New slots are null and get freshly linearized factors
+  result.resize(size());
+
+#ifdef GTSAM_USE_TBB
+
+  TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+
+  // First linearize all sendable factors
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, size()),
+    _LinearizeOneFactor(*this, linearizationPoint, result, true));
+
+  // Linearize all non-sendable factors
+  for (size_t i = 0; i < size(); i++) {
+    auto& factor = (*this)[i];
+    if (factor && !(factor->sendable())) {
+      factor->linearizeInto(linearizationPoint, result[i]);
+    }
+  }
+
+#else
+
+  for (size_t i = 0; i < size(); i++) {
+    if (factors_[i])
+      factors_[i]->linearizeInto(linearizationPoint, result[i]);
+    else
+      result[i] = GaussianFactor::shared_ptr();
+  }
+
+#endif
+}
+
 /* ************************************************************************* */
 static Scatter scatterFromValues(const Values& values) {
   gttic(scatterFromValues);
@@ -314,6 +394,27 @@ HessianFactor::shared_ptr NonlinearFactorGraph::linearizeToHessianFactor(
   // NOTE(frank): we are heavily leaning on friendship below
   HessianFactor::shared_ptr hessianFactor(new HessianFactor(scatter));
 
+#ifdef GTSAM_USE_TBB
+
+  // Each thread accumulates into its own Hessian, these are summed at the end.
+  // Threads are only split off when work is stolen, so the number of
+  // accumulators stays close to the number of threads.
+  TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+  _LinearizeIntoHessian body(*this, values, hessianFactor->keys_,
+                             hessianFactor->info_);
+  tbb::parallel_reduce(tbb::blocked_range<size_t>(0, size()), body);
+  hessianFactor->info_ = std::move(body.info_);
+
+  // Linearize all non-sendable factors
+  for (const sharedFactor& nonlinearFactor : factors_) {
+    if (nonlinearFactor && !nonlinearFactor->sendable()) {
+      const auto& gaussianFactor = nonlinearFactor->linearize(values);
+      gaussianFactor->updateHessian(hessianFactor->keys_, &hessianFactor->info_);
+    }
+  }
+
+#else
+
   // Initialize so we can rank-update below
   hessianFactor->info_.setZero();
 
@@ -326,6 +427,8 @@ HessianFactor::shared_ptr NonlinearFactorGraph::linearizeToHessianFactor(
     }
   }
 
+#endif
+
   if (dampen) dampen(hessianFactor);
 
   return hessianFactor;
@@ -129,6 +129,18 @@ namespace gtsam {
     /// Linearize a nonlinear factor graph
     std::shared_ptr<GaussianFactorGraph> linearize(const Values& linearizationPoint) const;
 
+    /**
+     * Linearize into an existing GaussianFactorGraph, typically the result of
+     * a previous call to linearize or linearizeInto on this graph. Factor i is
+     * linearized into slot i, and factors that support it (see
+     * NonlinearFactor::linearizeInto) overwrite the numeric values of the
+     * previous linear factor in place instead of allocating a new one. This
+     * avoids most allocations when repeatedly linearizing the same graph.
+     * Linear factors that are still referenced elsewhere are never modified.
+     */
+    void linearizeInto(const Values& linearizationPoint,
+                       GaussianFactorGraph& result) const;
+
     /// typdef for dampen functions used below
     typedef std::function<void(const std::shared_ptr<HessianFactor>& hessianFactor)> Dampen;
 
@@ -137,7 +149,9 @@ namespace gtsam {
      * into a HessianFactor. Avoids the many mallocs and pointer indirection in constructing
      * a new graph, and hence useful in case a dense solve is appropriate for your problem.
      * An optional lambda function can be used to apply damping on the filled Hessian.
-     * No parallelism is exploited, because all the factors write in the same memory.
+     * With TBB, each thread accumulates its factors into a private Hessian and
+     * these are summed at the end, which pays off when there are many more
+     * factors than variables.
      */
     std::shared_ptr<HessianFactor> linearizeToHessianFactor(
         const Values& values, const Dampen& dampen = nullptr) const;
@@ -148,7 +162,9 @@ namespace gtsam {
      * a new graph, and hence useful in case a dense solve is appropriate for your problem.
      * An ordering is given that still decides how the Hessian is laid out.
      * An optional lambda function can be used to apply damping on the filled Hessian.
-     * No parallelism is exploited, because all the factors write in the same memory.
+     * With TBB, each thread accumulates its factors into a private Hessian and
+     * these are summed at the end, which pays off when there are many more
+     * factors than variables.
      */
     std::shared_ptr<HessianFactor> linearizeToHessianFactor(
         const Values& values, const Ordering& ordering, const Dampen& dampen = nullptr) const;
@@ -22,6 +22,8 @@
 #include <gtsam/linear/VectorValues.h>
 #include <gtsam/linear/SubgraphSolver.h>
 #include <gtsam/linear/PCGSolver.h>
+#include <gtsam/linear/SparseCholeskySolver.h>
+#include <gtsam/linear/MultifrontalSolver.h>
 #include <gtsam/linear/GaussianFactorGraph.h>
 #include <gtsam/linear/VectorValues.h>
 
@@ -137,10 +139,20 @@ VectorValues NonlinearOptimizer::solve(const GaussianFactorGraph& gfg,
   // Check which solver we are using
   if (params.isMultifrontal()) {
     // Multifrontal QR or Cholesky (decided by params.getEliminationFunction())
-    if (params.ordering)
-      delta = gfg.optimize(*params.ordering, params.getEliminationFunction());
+    // The ordering and junction tree are only recomputed when the structure
+    // of the linear system changes.
+    if (!multifrontal_ || !multifrontal_->compatible(gfg)) {
+      multifrontal_ =
+          params.ordering
+              ? std::make_shared<MultifrontalSolver>(gfg, *params.ordering)
+              : std::make_shared<MultifrontalSolver>(gfg, Ordering::COLAMD);
+    }
+    if (params.reuseFrontalMatrices &&
+        params.linearSolverType == NonlinearOptimizerParams::MULTIFRONTAL_CHOLESKY &&
+        !hasConstraints(gfg))
+      delta = multifrontal_->optimizeCholesky(gfg);
     else
-      delta = gfg.optimize(params.getEliminationFunction());
+      delta = multifrontal_->optimize(gfg, params.getEliminationFunction());
   } else if (params.isSequential()) {
     // Sequential QR or Cholesky (decided by params.getEliminationFunction())
     if (params.ordering)
@@ -151,6 +163,16 @@ VectorValues NonlinearOptimizer::solve(const GaussianFactorGraph& gfg,
       delta = gfg.eliminateSequential(params.orderingType,
                                       params.getEliminationFunction())
                   ->optimize();
+  } else if (params.isCholmod()) {
+    // Sparse Cholesky on the assembled Hessian. The symbolic factorization is
+    // only redone when the structure of the linear system changes.
+    if (!sparseCholesky_ || !sparseCholesky_->compatible(gfg)) {
+      const Ordering ordering = params.ordering
+                                    ? *params.ordering
+                                    : Ordering::Create(params.orderingType, gfg);
+      sparseCholesky_ = std::make_shared<SparseCholeskySolver>(gfg, ordering);
+    }
+    delta = sparseCholesky_->solve(gfg);
   } else if (params.isIterative()) {
     // Conjugate Gradient -> needs params.iterativeParams
     if (!params.iterativeParams)
@@ -24,6 +24,8 @@
 namespace gtsam {
 
 namespace internal { struct NonlinearOptimizerState; }
+class SparseCholeskySolver;
+class MultifrontalSolver;
 
 /**
  * This is the abstract interface for classes that can optimize for the
@@ -79,6 +81,14 @@ protected:
 
   std::unique_ptr<internal::NonlinearOptimizerState> state_; ///< PIMPL'd state
 
+  /// Sparse Cholesky solver for the CHOLMOD linear solver type, which keeps
+  /// its symbolic factorization across iterations.
+  mutable std::shared_ptr<SparseCholeskySolver> sparseCholesky_;
+
+  /// Ordering and junction tree for the multifrontal linear solver types,
+  /// reused across iterations while the graph structure does not change.
+  mutable std::shared_ptr<MultifrontalSolver> multifrontal_;
+
 public:
   /** A shared pointer to this class */
   using shared_ptr = std::shared_ptr<const NonlinearOptimizer>;
@@ -108,6 +108,9 @@ void NonlinearOptimizerParams::print(const std::string& str) const {
     break;
   }
 
+  if (reuseFrontalMatrices)
+    std::cout << "     reuse frontal matrices: true\n";
+
   switch (orderingType){
   case Ordering::COLAMD:
     std::cout << "                   ordering: COLAMD\n";
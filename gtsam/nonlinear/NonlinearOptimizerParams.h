@@ -101,12 +101,13 @@ public:
     SEQUENTIAL_CHOLESKY,
     SEQUENTIAL_QR,
     Iterative, /* Experimental Flag */
-    CHOLMOD, /* Experimental Flag */
+    CHOLMOD, /* Sparse Cholesky with cached symbolic factorization, see SparseCholeskySolver */
   };
 
   LinearSolverType linearSolverType = MULTIFRONTAL_CHOLESKY; ///< The type of linear solver to use in the nonlinear optimizer
   std::optional<Ordering> ordering; ///< The optional variable elimination ordering, or empty to use COLAMD (default: empty)
   IterativeOptimizationParameters::shared_ptr iterativeParams; ///< The container for iterativeOptimization parameters. used in CG Solvers.
+  bool reuseFrontalMatrices = false; ///< With MULTIFRONTAL_CHOLESKY, keep the frontal matrices allocated across iterations instead of building a Bayes tree, see MultifrontalSolver::optimizeCholesky (default: false)
 
   NonlinearOptimizerParams() = default;
   virtual ~NonlinearOptimizerParams() {
@@ -0,0 +1,324 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file StaticExpression.h
+ * @brief Expressions whose structure is known at compile time
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/Expression.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <tuple>
+#include <utility>
+
+namespace gtsam {
+
+/**
+ * Base class of expressions whose whole tree is encoded in their type.
+ *
+ * An Expression is a tree of virtual ExpressionNodes, which is flexible but
+ * dispatches through virtual functions and execution trace records at every
+ * node. A StaticExpression instead composes StaticLeaf, StaticConstant and
+ * StaticFunction nodes by value, so the compiler sees the whole tree, and
+ * evaluating its value and Jacobians becomes a single inlined function with
+ * all intermediate Jacobians in fixed-size matrices on the stack.
+ *
+ * StaticExpressions are opt-in: pass one to the ExpressionFactor constructor,
+ * or to ExpressionFactor::initialize from a class derived from
+ * ExpressionFactorN, and the factor evaluates it with a fused kernel instead
+ * of the dynamic expression. All types in the expression must have a fixed
+ * dimension.
+ *
+ * Derived classes define `type`, `Dim`, `HasKeys`, a `Trace` struct, and the
+ * methods value, traceExecution, reverseAD, reverseADRoot and expression.
+ */
+template <class Derived>
+class StaticExpression {
+ public:
+  /// The derived expression
+  const Derived& derived() const { return static_cast<const Derived&>(*this); }
+};
+
+namespace internal {
+
+/// The Jacobian \c H as an OptionalJacobian, or none if it is not needed
+template <bool ACTIVE, int M, int N>
+OptionalJacobian<M, N> optionalJacobian(Eigen::Matrix<double, M, N>& H) {
+  if constexpr (ACTIVE)
+    return OptionalJacobian<M, N>(H);
+  else
+    return OptionalJacobian<M, N>();
+}
+
+}  // namespace internal
+
+/// A StaticExpression that retrieves a variable from Values
+template <typename T>
+class StaticLeaf : public StaticExpression<StaticLeaf<T> > {
+  Key key_;
+
+ public:
+  typedef T type;
+  static constexpr int Dim = traits<T>::dimension;
+  static constexpr bool HasKeys = true;
+  static_assert(Dim != Eigen::Dynamic,
+                "StaticExpression requires types of fixed dimension");
+
+  /// Leaves have nothing to record
+  struct Trace {};
+
+  /// Construct from the key of the variable
+  explicit StaticLeaf(Key key) : key_(key) {}
+
+  /// The value of the variable
+  T value(const Values& values) const { return values.at<T>(key_); }
+
+  /// The value of the variable
+  T traceExecution(const Values& values, Trace& /*trace*/) const {
+    return values.at<T>(key_);
+  }
+
+  /// Add the derivative dFdT of the root with respect to this variable
+  template <class MATRIX>
+  void reverseAD(const Trace& /*trace*/, const MATRIX& dFdT,
+                 internal::JacobianMap& jacobians) const {
+    jacobians(key_) += dFdT;
+  }
+
+  /// Add the derivative of this expression with respect to itself
+  void reverseADRoot(const Trace& /*trace*/,
+                     internal::JacobianMap& jacobians) const {
+    jacobians(key_) += Eigen::Matrix<double, Dim, Dim>::Identity();
+  }
+
+  /// The equivalent dynamic Expression
+  Expression<T> expression() const { return Expression<T>(key_); }
+};
+
+/// A StaticExpression with a constant value
+template <typename T>
+class StaticConstant : public StaticExpression<StaticConstant<T> > {
+  T constant_;
+
+ public:
+  typedef T type;
+  static constexpr int Dim = traits<T>::dimension;
+  static constexpr bool HasKeys = false;
+  static_assert(Dim != Eigen::Dynamic,
+                "StaticExpression requires types of fixed dimension");
+
+  /// Constants have nothing to record
+  struct Trace {};
+
+  /// Construct from the constant value
+  explicit StaticConstant(const T& value) : constant_(value) {}
+
+  /// The constant
+  const T& value(const Values& /*values*/) const { return constant_; }
+
+  /// The constant
+  const T& traceExecution(const Values& /*values*/, Trace& /*trace*/) const {
+    return constant_;
+  }
+
+  /// Constants have no derivatives
+  template <class MATRIX>
+  void reverseAD(const Trace& /*trace*/, const MATRIX& /*dFdT*/,
+                 internal::JacobianMap& /*jacobians*/) const {}
+
+  /// Constants have no derivatives
+  void reverseADRoot(const Trace& /*trace*/,
+                     internal::JacobianMap& /*jacobians*/) const {}
+
+  /// The equivalent dynamic Expression
+  Expression<T> expression() const { return Expression<T>(constant_); }
+};
+
+/**
+ * A StaticExpression that applies a function to the values of its child
+ * expressions. FUNCTION takes the child values followed by an OptionalJacobian
+ * for each of them, like the functions of Expression, and is typically a
+ * lambda so that it can be inlined.
+ */
+template <typename T, class FUNCTION, class... Children>
+class StaticFunction
+    : public StaticExpression<StaticFunction<T, FUNCTION, Children...> > {
+ public:
+  typedef T type;
+  static constexpr int Dim = traits<T>::dimension;
+  static constexpr bool HasKeys = (Children::HasKeys || ...);
+  static_assert(Dim != Eigen::Dynamic,
+                "StaticExpression requires types of fixed dimension");
+
+  /// Traces of the children, and the Jacobians with respect to them
+  struct Trace {
+    std::tuple<typename Children::Trace...> traces;
+    std::tuple<Eigen::Matrix<double, Dim, Children::Dim>...> H;
+  };
+
+ private:
+  typedef std::index_sequence_for<Children...> Indices;
+
+  FUNCTION function_;
+  std::tuple<Children...> children_;
+
+ public:
+  /// Construct from the function and the child expressions
+  StaticFunction(const FUNCTION& function, const Children&... children)
+      : function_(function), children_(children...) {}
+
+  /// The value, without derivatives
+  T value(const Values& values) const { return value(values, Indices()); }
+
+  /// The value, recording the Jacobians with respect to the children
+  T traceExecution(const Values& values, Trace& trace) const {
+    return traceExecution(values, trace, Indices());
+  }
+
+  /// Add the derivatives dFdT * H of the root to the children
+  template <class MATRIX>
+  void reverseAD(const Trace& trace, const MATRIX& dFdT,
+                 internal::JacobianMap& jacobians) const {
+    reverseAD(trace, dFdT, jacobians, Indices());
+  }
+
+  /// Add the derivatives H of this expression to the children
+  void reverseADRoot(const Trace& trace,
+                     internal::JacobianMap& jacobians) const {
+    reverseADRoot(trace, jacobians, Indices());
+  }
+
+  /// The equivalent dynamic Expression
+  Expression<T> expression() const { return expression(Indices()); }
+
+ private:
+  template <size_t... I>
+  T value(const Values& values, std::index_sequence<I...>) const {
+    return function_(
+        std::get<I>(children_).value(values)...,
+        typename MakeOptionalJacobian<T, typename Children::type>::type()...);
+  }
+
+  template <size_t... I>
+  T traceExecution(const Values& values, Trace& trace,
+                   std::index_sequence<I...>) const {
+    return function_(
+        std::get<I>(children_).traceExecution(values,
+                                              std::get<I>(trace.traces))...,
+        internal::optionalJacobian<Children::HasKeys>(std::get<I>(trace.H))...);
+  }
+
+  template <class MATRIX, size_t... I>
+  void reverseAD(const Trace& trace, const MATRIX& dFdT,
+                 internal::JacobianMap& jacobians,
+                 std::index_sequence<I...>) const {
+    (reverseADChild<I>(trace, dFdT, jacobians), ...);
+  }
+
+  template <size_t I, class MATRIX>
+  void reverseADChild(const Trace& trace, const MATRIX& dFdT,
+                      internal::JacobianMap& jacobians) const {
+    typedef std::tuple_element_t<I, std::tuple<Children...> > Child;
+    if constexpr (Child::HasKeys) {
+      const Eigen::Matrix<double, MATRIX::RowsAtCompileTime, Child::Dim> dFdA =
+          dFdT * std::get<I>(trace.H);
+      std::get<I>(children_).reverseAD(std::get<I>(trace.traces), dFdA,
+                                       jacobians);
+    }
+  }
+
+  template <size_t... I>
+  void reverseADRoot(const Trace& trace, internal::JacobianMap& jacobians,
+                     std::index_sequence<I...>) const {
+    (reverseADRootChild<I>(trace, jacobians), ...);
+  }
+
+  template <size_t I>
+  void reverseADRootChild(const Trace& trace,
+                          internal::JacobianMap& jacobians) const {
+    typedef std::tuple_element_t<I, std::tuple<Children...> > Child;
+    if constexpr (Child::HasKeys)
+      std::get<I>(children_).reverseAD(std::get<I>(trace.traces),
+                                       std::get<I>(trace.H), jacobians);
+  }
+
+  template <size_t... I>
+  Expression<T> expression(std::index_sequence<I...>) const {
+    static_assert(sizeof...(Children) <= 3,
+                  "StaticFunction::expression: Expression only has unary, "
+                  "binary and ternary function constructors");
+    // Same type as the Unary/Binary/TernaryFunction types of Expression
+    typedef std::function<T(
+        const typename Children::type&...,
+        typename MakeOptionalJacobian<T, typename Children::type>::type...)>
+        Function;
+    return Expression<T>(Function(function_),
+                         std::get<I>(children_).expression()...);
+  }
+};
+
+/// Create a StaticFunction of type T, deducing the other template arguments
+template <typename T, class FUNCTION, class... Children>
+StaticFunction<T, FUNCTION, Children...> staticFunction(
+    const FUNCTION& function, const StaticExpression<Children>&... children) {
+  return StaticFunction<T, FUNCTION, Children...>(function,
+                                                   children.derived()...);
+}
+
+namespace internal {
+
+/**
+ * Value and Jacobians of a StaticExpression with value type T, behind a
+ * single virtual call, so ExpressionFactor<T> can hold any StaticExpression.
+ */
+template <typename T>
+class StaticExpressionKernel {
+ public:
+  virtual ~StaticExpressionKernel() {}
+
+  /// The value of the expression
+  virtual T value(const Values& values) const = 0;
+
+  /// The value of the expression, adding its Jacobians to \c jacobians
+  virtual T valueAndJacobianMap(const Values& values,
+                                JacobianMap& jacobians) const = 0;
+};
+
+/// The fused kernel of a StaticExpression of type EXPRESSION
+template <class EXPRESSION>
+class StaticExpressionKernelImpl
+    : public StaticExpressionKernel<typename EXPRESSION::type> {
+  typedef typename EXPRESSION::type T;
+  EXPRESSION expression_;
+
+ public:
+  explicit StaticExpressionKernelImpl(const EXPRESSION& expression)
+      : expression_(expression) {}
+
+  T value(const Values& values) const override {
+    return expression_.value(values);
+  }
+
+  T valueAndJacobianMap(const Values& values,
+                        JacobianMap& jacobians) const override {
+    typename EXPRESSION::Trace trace;
+    T value = expression_.traceExecution(values, trace);
+    expression_.reverseADRoot(trace, jacobians);
+    return value;
+  }
+};
+
+}  // namespace internal
+}  // namespace gtsam
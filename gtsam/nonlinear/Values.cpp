@@ -24,15 +24,32 @@
 
 #include <gtsam/nonlinear/Values.h>
 #include <gtsam/linear/VectorValues.h>
+#include <gtsam/config.h> // for GTSAM_USE_TBB
+
+#ifdef GTSAM_USE_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
 
 #include <list>
 #include <memory>
 #include <sstream>
+#include <tuple>
+#include <vector>
 
 using namespace std;
 
 namespace gtsam {
 
+#ifdef GTSAM_USE_TBB
+  namespace {
+  // Below this size the serial loops are faster than spawning TBB tasks
+  const size_t kParallelThreshold = 1000;
+  // Number of values handled by a single task
+  const size_t kGrainSize = 256;
+  }
+#endif
+
   /* ************************************************************************* */
   Values::Values(const Values& other) {
     this->insert(other);
@@ -50,6 +67,32 @@ namespace gtsam {
 
   /* ************************************************************************* */
   Values::Values(const Values& other, const VectorValues& delta) {
+#ifdef GTSAM_USE_TBB
+    if (other.size() >= kParallelThreshold) {
+      // Retract (or clone) all values in parallel, then build the map serially
+      std::vector<std::pair<Key, const Value*>> entries;
+      entries.reserve(other.size());
+      for (const auto& [key, value] : other.values_)
+        entries.emplace_back(key, value.get());
+      std::vector<std::unique_ptr<Value>> results(entries.size());
+      tbb::parallel_for(
+          tbb::blocked_range<size_t>(0, entries.size(), kGrainSize),
+          [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+              const auto& [key, value] = entries[i];
+              VectorValues::const_iterator it = delta.find(key);
+              results[i].reset((it != delta.end()) ? value->retract_(it->second)
+                                                   : value->clone_());
+            }
+          });
+      // Keys are sorted, so every insertion hint is exact. Results are owned by
+      // unique_ptrs until then, so none leak if a retraction throws.
+      for (size_t i = 0; i < entries.size(); ++i)
+        values_.emplace_hint(values_.end(), entries[i].first,
+                             std::move(results[i]));
+      return;
+    }
+#endif
     for (const auto& [key,value] : other.values_) {
       VectorValues::const_iterator it = delta.find(key);
       if (it != delta.end()) {
@@ -99,6 +142,32 @@ namespace gtsam {
     return Values(*this, delta);
   }
 
+  /* ************************************************************************* */
+  void Values::retractInPlace(const VectorValues& delta) {
+    gttic(retractInPlace);
+#ifdef GTSAM_USE_TBB
+    if (size() >= kParallelThreshold) {
+      std::vector<std::pair<Value*, const Vector*>> entries;
+      entries.reserve(delta.size());
+      for (auto& [key, value] : values_) {
+        VectorValues::const_iterator it = delta.find(key);
+        if (it != delta.end()) entries.emplace_back(value.get(), &it->second);
+      }
+      tbb::parallel_for(
+          tbb::blocked_range<size_t>(0, entries.size(), kGrainSize),
+          [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i != range.end(); ++i)
+              entries[i].first->retractInPlace_(*entries[i].second);
+          });
+      return;
+    }
+#endif
+    for (auto& [key, value] : values_) {
+      VectorValues::const_iterator it = delta.find(key);
+      if (it != delta.end()) value->retractInPlace_(it->second);
+    }
+  }
+
   /* ************************************************************************* */
   void Values::retractMasked(const VectorValues& delta, const KeySet& mask) {
     gttic(retractMasked);
@@ -116,12 +185,7 @@ namespace gtsam {
       Key var = key_value->first;
       assert(static_cast<size_t>(delta[var].size()) == key_value->second->dim());
       assert(delta[var].allFinite());
-      if (mask.exists(var)) {
-        Value* retracted = key_value->second->retract_(delta[var]);
-        // TODO(dellaert): can we use std::move here?
-        *(key_value->second) = *retracted;
-        retracted->deallocate_();
-      }
+      if (mask.exists(var)) key_value->second->retractInPlace_(delta[var]);
     }
   }
 
@@ -130,6 +194,29 @@ namespace gtsam {
     if(this->size() != cp.size())
       throw DynamicValuesMismatched();
     VectorValues result;
+#ifdef GTSAM_USE_TBB
+    if (size() >= kParallelThreshold) {
+      std::vector<std::tuple<Key, const Value*, const Value*>> entries;
+      entries.reserve(size());
+      for (auto it1 = values_.begin(), it2 = cp.values_.begin();
+           it1 != values_.end(); ++it1, ++it2) {
+        if(it1->first != it2->first)
+          throw DynamicValuesMismatched(); // If keys do not match
+        entries.emplace_back(it1->first, it1->second.get(), it2->second.get());
+      }
+      // VectorValues is a concurrent map when using TBB, so we can insert
+      // from all threads.
+      tbb::parallel_for(
+          tbb::blocked_range<size_t>(0, entries.size(), kGrainSize),
+          [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+              const auto& [key, value1, value2] = entries[i];
+              result.emplace(key, value1->localCoordinates_(*value2));
+            }
+          });
+      return result;
+    }
+#endif
     for (auto it1 = values_.begin(), it2 = cp.values_.begin();
          it1 != values_.end(); ++it1, ++it2) {
       if(it1->first != it2->first)
@@ -219,16 +219,25 @@ namespace gtsam {
     /// @name Manifold Operations
     /// @{
 
-    /** Add a delta config to current config and returns a new config */
+    /** Add a delta config to current config and returns a new config.
+     * When compiled with TBB, large configs are retracted in parallel. */
     Values retract(const VectorValues& delta) const;
 
+    /**
+     * Add a delta config to current config, in place. Only Keys appearing in
+     * \c delta are changed. Unlike retract, this reuses the existing Value
+     * storage and does not allocate per variable.
+     */
+    void retractInPlace(const VectorValues& delta);
+
     /**
      * Retract, but only for Keys appearing in \c mask. In-place.
      * \param mask Mask on Keys where to apply retract.
      */
     void retractMasked(const VectorValues& delta, const KeySet& mask);
 
-    /** Get a delta config about a linearization point c0 (*this) */
+    /** Get a delta config about a linearization point c0 (*this).
+     * When compiled with TBB, large configs are processed in parallel. */
     VectorValues localCoordinates(const Values& cp) const;
 
     ///@}
@@ -477,8 +477,11 @@ class ISAM2Result {
   /** Getters and Setters for all properties */
   size_t getVariablesRelinearized() const;
   size_t getVariablesReeliminated() const;
+  size_t getVariablesDeferred() const;
+  double getDeferredCost() const;
   gtsam::FactorIndices getNewFactorsIndices() const;
   size_t getCliques() const;
+  bool isWithinMemoryLimits() const;
   double getErrorBefore() const;
   double getErrorAfter() const;
 };
@@ -0,0 +1,128 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    testAsyncISAM2.cpp
+ * @brief   Unit tests for AsyncISAM2
+ */
+
+#include <gtsam/nonlinear/AsyncISAM2.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <gtsam/base/TestableAssertions.h>
+#include <CppUnitLite/TestHarness.h>
+
+using namespace std;
+using namespace gtsam;
+using symbol_shorthand::X;
+
+namespace {
+const SharedDiagonal odoNoise =
+    noiseModel::Diagonal::Sigmas(Vector3(0.1, 0.1, 0.05));
+
+// The factors and initial values of step t of a Pose2 trajectory, with a loop
+// closure to the first pose every five steps
+pair<NonlinearFactorGraph, Values> step(size_t t) {
+  NonlinearFactorGraph graph;
+  Values init;
+  init.insert(X(t), Pose2(t + 0.1, 0.05 * t, 0.01 * t));
+  if (t == 0) {
+    graph.addPrior(X(0), Pose2(), odoNoise);
+  } else {
+    graph.emplace_shared<BetweenFactor<Pose2>>(X(t - 1), X(t),
+                                               Pose2(1, 0, 0), odoNoise);
+    if (t % 5 == 0)
+      graph.emplace_shared<BetweenFactor<Pose2>>(X(0), X(t), Pose2(t, 0, 0),
+                                                 odoNoise);
+  }
+  return {graph, init};
+}
+}  // namespace
+
+/* ************************************************************************* */
+TEST(AsyncISAM2, matchesISAM2) {
+  const ISAM2Params params(ISAM2GaussNewtonParams(), 0.01, 1);
+  ISAM2 isam(params);
+  AsyncISAM2 async(params);
+  EXPECT_LONGS_EQUAL(0, async.updatesCompleted());
+  EXPECT(async.calculateEstimate().empty());
+
+  ISAM2Result expectedResult;
+  const size_t n = 20;
+  for (size_t t = 0; t < n; ++t) {
+    const auto [graph, init] = step(t);
+    expectedResult = isam.update(graph, init);
+    async.update(graph, init);
+
+    // Queries never block and see some completed update
+    const auto snapshot = async.snapshot();
+    EXPECT(snapshot->updates <= t + 1);
+    EXPECT_LONGS_EQUAL(snapshot->updates, snapshot->estimate.size());
+  }
+
+  async.waitUntilIdle();
+  EXPECT_LONGS_EQUAL(0, async.updatesPending());
+  EXPECT_LONGS_EQUAL(n, async.updatesCompleted());
+  EXPECT(assert_equal(isam.calculateEstimate(), async.calculateEstimate(),
+                      1e-9));
+  EXPECT(assert_equal(isam.calculateEstimate<Pose2>(X(7)),
+                      async.calculateEstimate<Pose2>(X(7)), 1e-9));
+  EXPECT(expectedResult.newFactorsIndices ==
+         async.lastResult().newFactorsIndices);
+  EXPECT_LONGS_EQUAL(isam.getFactorsUnsafe().size(),
+                     async.isam2().getFactorsUnsafe().size());
+
+  // Factor indices of completed updates can be used to remove factors
+  ISAM2UpdateParams removeParams;
+  removeParams.removeFactorIndices = expectedResult.newFactorsIndices;
+  isam.update(NonlinearFactorGraph(), Values(), removeParams);
+  async.update(NonlinearFactorGraph(), Values(), removeParams);
+  async.waitUntilIdle();
+  EXPECT(assert_equal(isam.calculateEstimate(), async.calculateEstimate(),
+                      1e-9));
+}
+
+/* ************************************************************************* */
+TEST(AsyncISAM2, error) {
+  AsyncISAM2 async;
+  const auto [graph, init] = step(0);
+  async.update(graph, init);
+
+  // A factor on a variable without initial value fails on the worker thread
+  NonlinearFactorGraph bad;
+  bad.emplace_shared<BetweenFactor<Pose2>>(X(0), X(5), Pose2(), odoNoise);
+  async.update(bad, Values());
+  CHECK_EXCEPTION(async.waitUntilIdle(), std::exception);
+
+  // The error is reported only once, and the estimate is the last good one
+  async.waitUntilIdle();
+  EXPECT_LONGS_EQUAL(1, async.updatesCompleted());
+  EXPECT_LONGS_EQUAL(1, async.calculateEstimate().size());
+}
+
+/* ************************************************************************* */
+TEST(AsyncISAM2, destructor) {
+  // Destruction with queued updates completes them and stops the worker
+  AsyncISAM2 async;
+  for (size_t t = 0; t < 10; ++t) {
+    const auto [graph, init] = step(t);
+    async.update(graph, init);
+  }
+}
+
+/* ************************************************************************* */
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
+/* ************************************************************************* */
@@ -237,6 +237,77 @@ TEST( BatchFixedLagSmoother, Example )
   }
 }
 
+/* ************************************************************************* */
+TEST( BatchFixedLagSmoother, Incremental )
+{
+  // In a pure linear environment the incremental mode is exact as well, while
+  // each odometry update only optimizes the two newest variables
+  SharedDiagonal odometerNoise = noiseModel::Diagonal::Sigmas(Vector2(0.1, 0.1));
+  SharedDiagonal loopNoise = noiseModel::Diagonal::Sigmas(Vector2(0.1, 0.1));
+
+  typedef BatchFixedLagSmoother::KeyTimestampMap Timestamps;
+  BatchFixedLagSmoother smoother(7.0, LevenbergMarquardtParams(), true, true);
+  EXPECT(smoother.incremental());
+
+  Values fullinit;
+  NonlinearFactorGraph fullgraph;
+  const auto extra = std::make_shared<BetweenFactor<Point2>>(
+      Key(15), Key(16), Point2(1.3, 0.2), odometerNoise);
+
+  for (size_t i = 0; i <= 20; ++i) {
+    const Key key2(i);
+    NonlinearFactorGraph newFactors;
+    Values newValues;
+    Timestamps newTimestamps;
+
+    if (i == 0) {
+      newFactors.addPrior(key2, Point2(0.0, 0.0), odometerNoise);
+    } else {
+      newFactors.push_back(BetweenFactor<Point2>(Key(i - 1), key2, Point2(1.0, 0.0), odometerNoise));
+    }
+    // Loop closures to eliminated variables
+    const bool loop = (i == 6 || i == 13);
+    if (i == 6)
+      newFactors.push_back(BetweenFactor<Point2>(Key(2), Key(5), Point2(3.5, 0.0), loopNoise));
+    if (i == 13)
+      newFactors.push_back(BetweenFactor<Point2>(Key(8), Key(12), Point2(4.2, 0.1), loopNoise));
+    // A second odometry measurement, removed once it is eliminated
+    if (i == 16)
+      newFactors.push_back(extra);
+    newValues.insert(key2, Point2(double(i)+0.1, -0.1));
+    newTimestamps[key2] = double(i);
+
+    fullgraph.push_back(newFactors);
+    fullinit.insert(newValues);
+
+    const FixedLagSmoother::Result result =
+        smoother.update(newFactors, newValues, newTimestamps);
+    if (!loop)
+      EXPECT(result.nonlinearVariables + result.linearVariables <= 2);
+
+    // Both the newest and the eliminated variables match the full solution
+    CHECK(check_smoother(fullgraph, fullinit, smoother, key2));
+    if (i >= 3)
+      CHECK(check_smoother(fullgraph, fullinit, smoother, Key(i - 3)));
+  }
+
+  // Old variables were marginalized
+  EXPECT(!smoother.getLinearizationPoint().exists(Key(5)));
+  EXPECT(smoother.getLinearizationPoint().exists(Key(14)));
+
+  // Removing an eliminated factor gives the solution without it
+  const NonlinearFactorGraph factors = smoother.getFactors();
+  size_t slot = 0;
+  while (factors[slot] != extra) ++slot;
+  smoother.update(NonlinearFactorGraph(), Values(), Timestamps(), {slot});
+  NonlinearFactorGraph reducedgraph;
+  for (const auto& factor : fullgraph)
+    if (factor != extra) reducedgraph.push_back(factor);
+  CHECK(check_smoother(reducedgraph, fullinit, smoother, Key(15)));
+  CHECK(check_smoother(reducedgraph, fullinit, smoother, Key(16)));
+  CHECK(check_smoother(reducedgraph, fullinit, smoother, Key(20)));
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
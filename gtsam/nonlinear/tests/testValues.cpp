@@ -347,6 +347,52 @@ TEST(Values, retract_masked)
   CHECK(assert_equal(expected, config0));
 }
 
+/* ************************************************************************* */
+TEST(Values, retractInPlace)
+{
+  Values config0;
+  config0.insert(key1, Vector3(1.0, 2.0, 3.0));
+  config0.insert(key2, Pose2(1.0, 2.0, 0.3));
+
+  const VectorValues delta{{key2, Vector3(0.1, 0.2, 0.3)}};
+
+  Values expected = config0.retract(delta);
+  config0.retractInPlace(delta);
+  CHECK(assert_equal(expected, config0));
+}
+
+/* ************************************************************************* */
+TEST(Values, retractLarge)
+{
+  // Large enough to take the parallel code paths when using TBB
+  Values config0;
+  VectorValues delta;
+  Values expected;
+  for (size_t j = 0; j < 3000; ++j) {
+    const Pose2 pose(0.1 * j, -0.2 * j, 0.001 * j);
+    config0.insert(j, pose);
+    if (j % 3 != 0) {
+      const Vector3 d(0.01 * j, 0.2, -0.001 * j);
+      delta.insert(j, d);
+      expected.insert(j, pose.retract(d));
+    } else {
+      expected.insert(j, pose);
+    }
+  }
+
+  Values actual = config0.retract(delta);
+  CHECK(assert_equal(expected, actual));
+
+  Values inPlace(config0);
+  inPlace.retractInPlace(delta);
+  CHECK(assert_equal(expected, inPlace));
+
+  // localCoordinates recovers delta, with zeros where delta had no entry
+  VectorValues expectedDelta = config0.zeroVectors();
+  expectedDelta.update(delta);
+  CHECK(assert_equal(expectedDelta, config0.localCoordinates(actual)));
+}
+
 /* ************************************************************************* */
 TEST(Values, equals)
 {
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <gtsam/nonlinear/expressions.h>
+#include <gtsam/nonlinear/StaticExpression.h>
 #include <gtsam/geometry/Pose2.h>
 #include <gtsam/geometry/Cal3_S2.h>
 #include <gtsam/geometry/Cal3Bundler.h>
@@ -195,4 +196,51 @@ gtsam::Expression<typename gtsam::traits<T>::TangentVector> logmap(
       gtsam::traits<T>::Logmap, between(x1, x2));
 }
 
+// Static expressions for structure from motion, see StaticExpression.h. These
+// overloads let the expressions above be reused with StaticLeaf arguments.
+
+template <class E1, class E2>
+auto transformTo(const StaticExpression<E1>& x,
+                 const StaticExpression<E2>& p) {
+  return staticFunction<Point3>(
+      [](const Pose3& pose, const Point3& point, OptionalJacobian<3, 6> H1,
+         OptionalJacobian<3, 3> H2) {
+        return pose.transformTo(point, H1, H2);
+      },
+      x, p);
+}
+
+template <class E1, class E2>
+auto transformFrom(const StaticExpression<E1>& x,
+                   const StaticExpression<E2>& p) {
+  return staticFunction<Point3>(
+      [](const Pose3& pose, const Point3& point, OptionalJacobian<3, 6> H1,
+         OptionalJacobian<3, 3> H2) {
+        return pose.transformFrom(point, H1, H2);
+      },
+      x, p);
+}
+
+template <class E>
+auto project(const StaticExpression<E>& p_cam) {
+  return staticFunction<Point2>(
+      [](const Point3& point, OptionalJacobian<2, 3> H) {
+        return PinholeBase::Project(point, H);
+      },
+      p_cam);
+}
+
+template <class E1, class E2>
+auto uncalibrate(const StaticExpression<E1>& K,
+                 const StaticExpression<E2>& xy_hat) {
+  typedef typename E1::type CALIBRATION;
+  return staticFunction<Point2>(
+      [](const CALIBRATION& calibration, const Point2& point,
+         typename MakeOptionalJacobian<Point2, CALIBRATION>::type H1,
+         OptionalJacobian<2, 2> H2) {
+        return calibration.uncalibrate(point, H1, H2);
+      },
+      K, xy_hat);
+}
+
 }  // \namespace gtsam
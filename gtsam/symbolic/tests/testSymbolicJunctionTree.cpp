@@ -54,6 +54,21 @@ TEST( JunctionTree, constructor )
   EXPECT(assert_equal(*simpleChain[1],   *actual.roots().front()->children.front()->factors[1]));
 }
 
+/* ************************************************************************* */
+TEST( JunctionTree, cost )
+{
+  const Ordering order{0, 1, 2, 3};
+  SymbolicJunctionTree actual(SymbolicEliminationTree(simpleChain, order));
+
+  // Root {2, 3} has no separator, child {0, 1} has separator {2}
+  const auto& root = actual.roots().front();
+  const auto& child = root->children.front();
+  EXPECT_DOUBLES_EQUAL(8.0 / 3.0, root->cost(), 1e-9);
+  EXPECT_DOUBLES_EQUAL(8.0 / 3.0 + 4.0 + 2.0, child->cost(), 1e-9);
+  EXPECT_DOUBLES_EQUAL(child->cost(), child->subtreeCost(), 1e-9);
+  EXPECT_DOUBLES_EQUAL(root->cost() + child->cost(), root->subtreeCost(), 1e-9);
+}
+
 /* ************************************************************************* */
 int main() {
   TestResult tr;
@@ -110,6 +110,30 @@ TEST(VariableIndex, remove) {
   CHECK(assert_equal(expected, actual));
 }
 
+/* ************************************************************************* */
+TEST(VariableIndex, renumberFactors) {
+
+  auto fg1 = testGraph1(), fg2 = testGraph2();
+
+  // Remove the factors of fg1 and renumber those of fg2 from zero
+  SymbolicFactorGraph fgCombined; fgCombined.push_back(fg1); fgCombined.push_back(fg2);
+  VariableIndex actual(fgCombined);
+  vector<size_t> indices{0, 1, 2, 3};
+  actual.remove(indices.begin(), indices.end(), fg1);
+  std::list<Key> unusedVariables{0, 9};
+  actual.removeUnusedVariables(unusedVariables.begin(), unusedVariables.end());
+  const FactorIndex none = std::numeric_limits<FactorIndex>::max();
+  actual.renumberFactors(FactorIndices{none, none, none, none, 0, 1, 2, 3}, 4);
+
+  CHECK(assert_equal(VariableIndex(fg2), actual));
+
+  // Factors still in the index must have a new index
+  VariableIndex all(fgCombined);
+  CHECK_EXCEPTION(
+      all.renumberFactors(FactorIndices{none, none, none, none, 0, 1, 2, 3}, 4),
+      std::invalid_argument);
+}
+
 /* ************************************************************************* */
 TEST(VariableIndex, deep_copy) {
 
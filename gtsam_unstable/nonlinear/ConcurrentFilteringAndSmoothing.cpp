@@ -22,6 +22,8 @@
 #include <gtsam_unstable/nonlinear/ConcurrentFilteringAndSmoothing.h>
 #include <gtsam/nonlinear/LinearContainerFactor.h>
 
+#include <memory>
+
 namespace gtsam {
 
 /* ************************************************************************* */
@@ -48,6 +50,63 @@ void synchronize(ConcurrentFilter& filter, ConcurrentSmoother& smoother) {
   smoother.postsync();
 }
 
+/* ************************************************************************* */
+ConcurrentSynchronizer::~ConcurrentSynchronizer() {
+  delete toSmoother_.load();
+  delete toFilter_.load();
+}
+
+/* ************************************************************************* */
+bool ConcurrentSynchronizer::filterSynchronize(ConcurrentFilter& filter) {
+
+  // Wait for the answer to the last message, without blocking
+  std::unique_ptr<Message> answer(toFilter_.exchange(nullptr, std::memory_order_acquire));
+  if(awaitingAnswer_ && !answer)
+    return false;
+
+  filter.presync();
+
+  // Apply the smoother summarization, empty before the first message
+  if(answer)
+    filter.synchronize(answer->summarizedFactors, answer->separatorValues);
+  else
+    filter.synchronize(NonlinearFactorGraph(), Values());
+
+  // Send the new smoother factors and the filter summarization
+  auto message = std::make_unique<Message>();
+  filter.getSmootherFactors(message->smootherFactors, message->smootherValues);
+  filter.getSummarizedFactors(message->summarizedFactors, message->separatorValues);
+  toSmoother_.store(message.release(), std::memory_order_release);
+  awaitingAnswer_ = true;
+
+  filter.postsync();
+  return true;
+}
+
+/* ************************************************************************* */
+bool ConcurrentSynchronizer::smootherSynchronize(ConcurrentSmoother& smoother) {
+
+  // The filter only sends a message after the answer to the previous one
+  if(answerOwed_) {
+    auto answer = std::make_unique<Message>();
+    smoother.getSummarizedFactors(answer->summarizedFactors, answer->separatorValues);
+    toFilter_.store(answer.release(), std::memory_order_release);
+    answerOwed_ = false;
+    return false;
+  }
+
+  std::unique_ptr<Message> message(toSmoother_.exchange(nullptr, std::memory_order_acquire));
+  if(!message)
+    return false;
+
+  smoother.presync();
+  smoother.synchronize(message->smootherFactors, message->smootherValues,
+      message->summarizedFactors, message->separatorValues);
+  smoother.postsync();
+  answerOwed_ = true;
+  return true;
+}
+
 namespace internal {
 
 /* ************************************************************************* */
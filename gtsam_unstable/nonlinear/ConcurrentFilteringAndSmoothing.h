@@ -25,6 +25,8 @@
 #include <gtsam/nonlinear/Values.h>
 #include <gtsam/linear/GaussianFactorGraph.h>
 
+#include <atomic>
+
 namespace gtsam {
 
 // Forward declare the Filter and Smoother classes for the 'synchronize' function
@@ -151,6 +153,69 @@ public:
 
 }; // ConcurrentSmoother
 
+/**
+ * Synchronizes a filter and a smoother running on different threads, without
+ * pausing either of them.
+ *
+ * Instead of calling synchronize() while both are paused, the filter thread
+ * calls filterSynchronize() between filter updates, and the smoother thread
+ * calls smootherSynchronize() between smoother updates. The two messages of
+ * the synchronize() handshake are passed through one single-slot mailbox per
+ * direction, published and consumed by exchanging an atomic pointer, so
+ * neither call blocks or waits for the other thread. The messages only hold
+ * the factors and values produced by the get* methods, which share the
+ * factors themselves.
+ *
+ * The filter only sends new smoother factors once the smoother has answered
+ * the previous ones with its summarization on the same separator, which the
+ * smoother computes in the update() that follows smootherSynchronize(). In
+ * the meantime the filter keeps accumulating smoother factors, as it does
+ * between calls to synchronize(). The filter and smoother thus see the same
+ * sequence of calls as with synchronize().
+ */
+class GTSAM_UNSTABLE_EXPORT ConcurrentSynchronizer {
+public:
+  ConcurrentSynchronizer() = default;
+
+  /** Deletes any message that was not consumed */
+  ~ConcurrentSynchronizer();
+
+  ConcurrentSynchronizer(const ConcurrentSynchronizer&) = delete;
+  ConcurrentSynchronizer& operator=(const ConcurrentSynchronizer&) = delete;
+
+  /**
+   * Called by the filter thread between filter updates. If the smoother has
+   * answered the last message, applies its summarization to the filter and
+   * sends the new smoother factors and the filter summarization.
+   * @return whether a message was sent to the smoother
+   */
+  bool filterSynchronize(ConcurrentFilter& filter);
+
+  /**
+   * Called by the smoother thread between smoother updates. Answers the last
+   * message with the smoother summarization computed by the update since,
+   * and applies a new message of the filter, if any.
+   * @return whether a message was applied, so that the smoother needs an update
+   */
+  bool smootherSynchronize(ConcurrentSmoother& smoother);
+
+private:
+  /** The factors and values passed by synchronize() */
+  struct Message {
+    NonlinearFactorGraph smootherFactors;  ///< Empty from the smoother
+    Values smootherValues;                 ///< Empty from the smoother
+    NonlinearFactorGraph summarizedFactors;
+    Values separatorValues;
+  };
+
+  std::atomic<Message*> toSmoother_{nullptr};
+  std::atomic<Message*> toFilter_{nullptr};
+
+  bool awaitingAnswer_ = false;  ///< Only accessed by the filter thread
+  bool answerOwed_ = false;      ///< Only accessed by the smoother thread
+
+}; // ConcurrentSynchronizer
+
 namespace internal {
 
   /** Calculate the marginal on the specified keys, returning a set of LinearContainerFactors.
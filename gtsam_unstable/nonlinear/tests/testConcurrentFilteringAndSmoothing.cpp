@@ -0,0 +1,139 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    testConcurrentFilteringAndSmoothing.cpp
+ * @brief   Unit tests for the ConcurrentSynchronizer
+ */
+
+#include <gtsam_unstable/nonlinear/ConcurrentBatchFilter.h>
+#include <gtsam_unstable/nonlinear/ConcurrentBatchSmoother.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <CppUnitLite/TestHarness.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace std;
+using namespace gtsam;
+
+namespace {
+
+const SharedDiagonal noisePrior = noiseModel::Diagonal::Sigmas(Vector3(0.3, 0.3, 0.1));
+const SharedDiagonal noiseOdometry = noiseModel::Diagonal::Sigmas(Vector3(0.1, 0.1, 0.05));
+
+// The factors and values of step i of a Pose2 trajectory
+void step(size_t i, NonlinearFactorGraph* newFactors, Values* newValues) {
+  if(i == 0) {
+    newFactors->addPrior(0, Pose2(), noisePrior);
+  } else {
+    newFactors->push_back(BetweenFactor<Pose2>(i - 1, i, Pose2(0.61, -0.08, 0.02), noiseOdometry));
+  }
+  newValues->insert(i, Pose2(0.5 * i, 0.0, 0.0));
+}
+
+// Keys to move to the smoother at step i, keeping a lag of eight steps
+FastList<Key> oldKeys(size_t i) {
+  FastList<Key> keys;
+  if(i >= 9) keys.push_back(i - 9);
+  return keys;
+}
+
+}
+
+/* ************************************************************************* */
+TEST( ConcurrentSynchronizer, matchesSynchronize )
+{
+  // The same sequence of updates, synchronized with synchronize() while both
+  // sides are paused and with the synchronizer
+  ConcurrentBatchFilter filter1, filter2;
+  ConcurrentBatchSmoother smoother1, smoother2;
+  ConcurrentSynchronizer synchronizer;
+
+  for(size_t i = 0; i <= 40; ++i) {
+    NonlinearFactorGraph newFactors;
+    Values newValues;
+    step(i, &newFactors, &newValues);
+    filter1.update(newFactors, newValues, oldKeys(i));
+    filter2.update(newFactors, newValues, oldKeys(i));
+
+    if(i % 4 == 0) {
+      smoother1.update();
+      synchronize(filter1, smoother1);
+
+      // The smoother answers with the summarization of its last update
+      smoother2.update();
+      synchronizer.smootherSynchronize(smoother2);
+      EXPECT(synchronizer.filterSynchronize(filter2));
+      EXPECT(synchronizer.smootherSynchronize(smoother2));
+
+      // No answer yet, so the filter does not send anything new
+      EXPECT(!synchronizer.filterSynchronize(filter2));
+    }
+  }
+
+  EXPECT(assert_equal(filter1.calculateEstimate(), filter2.calculateEstimate(), 1e-9));
+  smoother1.update();
+  smoother2.update();
+  EXPECT(assert_equal(smoother1.calculateEstimate(), smoother2.calculateEstimate(), 1e-9));
+}
+
+/* ************************************************************************* */
+TEST( ConcurrentSynchronizer, threads )
+{
+  // The filter and smoother run on their own threads and never wait
+  ConcurrentBatchFilter filter;
+  ConcurrentBatchSmoother smoother;
+  ConcurrentSynchronizer synchronizer;
+  std::atomic<bool> filterDone(false);
+
+  NonlinearFactorGraph fullGraph;
+  Values fullInit;
+  const size_t n = 60;
+
+  std::thread smootherThread([&]() {
+    while(!filterDone) {
+      if(synchronizer.smootherSynchronize(smoother))
+        smoother.update();
+      std::this_thread::yield();
+    }
+  });
+
+  for(size_t i = 0; i < n; ++i) {
+    NonlinearFactorGraph newFactors;
+    Values newValues;
+    step(i, &newFactors, &newValues);
+    fullGraph.push_back(newFactors);
+    fullInit.insert(newValues);
+    filter.update(newFactors, newValues, oldKeys(i));
+    synchronizer.filterSynchronize(filter);
+  }
+  filterDone = true;
+  smootherThread.join();
+
+  // Drain the last exchange on this thread
+  synchronizer.smootherSynchronize(smoother);
+  synchronizer.filterSynchronize(filter);
+  if(synchronizer.smootherSynchronize(smoother))
+    smoother.update();
+
+  // The filter still tracks the full solution
+  const Values expected = LevenbergMarquardtOptimizer(fullGraph, fullInit).optimize();
+  EXPECT(smoother.calculateEstimate().size() > 0);
+  EXPECT(assert_equal(expected.at<Pose2>(n - 1), filter.calculateEstimate<Pose2>(n - 1), 1e-3));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -770,6 +770,39 @@ TEST(ExpressionFactor, dotProduct) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-5, 1e-5)
 }
 
+/* ************************************************************************* */
+TEST(ExpressionFactor, linearizeInto) {
+  Pose3_ x(1);
+  Point3_ p(2);
+  SharedNoiseModel sigma = noiseModel::Isotropic::Sigma(2, 0.5);
+  ExpressionFactor<Point2> factor(sigma, Point2(0.1, 0.2),
+                                  project(transformTo(x, p)));
+  Values values;
+  values.insert(1, Pose3(Rot3::Ypr(0.1, 0.2, 0.3), Point3(0, 0, -5)));
+  values.insert(2, Point3(0.3, 0.2, 0.1));
+
+  // The first linearization creates a new factor
+  GaussianFactor::shared_ptr result;
+  factor.linearizeInto(values, result);
+  EXPECT(assert_equal(*factor.linearize(values), *result, 1e-9));
+
+  // Relinearizing overwrites it in place
+  const GaussianFactor* storage = result.get();
+  const double* data =
+      std::static_pointer_cast<JacobianFactor>(result)->matrixObject().matrix().data();
+  values.update(2, Point3(0.5, -0.2, 0.4));
+  factor.linearizeInto(values, result);
+  EXPECT(storage == result.get());
+  EXPECT(data == std::static_pointer_cast<JacobianFactor>(result)
+                     ->matrixObject().matrix().data());
+  EXPECT(assert_equal(*factor.linearize(values), *result, 1e-9));
+
+  // A factor shared with someone else is replaced
+  GaussianFactor::shared_ptr shared = result;
+  factor.linearizeInto(values, result);
+  EXPECT(shared != result);
+  EXPECT(assert_equal(*shared, *result, 1e-9));
+}
 
 /* ************************************************************************* */
 int main() {
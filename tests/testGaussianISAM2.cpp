@@ -15,6 +15,8 @@
 #include <gtsam/nonlinear/Values.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Marginals.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/inference/Symbol.h>
 #include <gtsam/linear/GaussianBayesNet.h>
 #include <gtsam/linear/GaussianBayesTree.h>
 #include <gtsam/linear/GaussianFactorGraph.h>
@@ -25,6 +27,8 @@
 
 #include <CppUnitLite/TestHarness.h>
 
+#include <numeric>
+
 
 using namespace std;
 using namespace gtsam;
@@ -731,6 +735,35 @@ namespace {
   }
 }
 
+/* ************************************************************************* */
+TEST(ISAM2, covariancesAfterMarginalizeLeaves)
+{
+  // Two poses eliminated into a single clique, x0 first
+  NonlinearFactorGraph factors;
+  factors.addPrior(0, Pose2(), noiseModel::Isotropic::Sigma(3, 0.1));
+  factors.emplace_shared<BetweenFactor<Pose2>>(0, 1, Pose2(1.0, 0.0, 0.1),
+                                               odoNoise);
+  Values values;
+  values.insert(0, Pose2());
+  values.insert(1, Pose2(1.0, 0.0, 0.1));
+  FastMap<Key, int> constrainedKeys;
+  constrainedKeys.insert(make_pair(0, 0));
+  constrainedKeys.insert(make_pair(1, 1));
+  ISAM2 isam;
+  isam.update(factors, values, FactorIndices(), constrainedKeys);
+  LONGS_EQUAL(1, isam.roots().size());
+  LONGS_EQUAL(2, isam.roots().front()->conditional()->nrFrontals());
+  isam.covariances();
+
+  // Marginalizing x0 trims the conditional of the clique in place, so its
+  // inverse must not be reused
+  isam.marginalizeLeaves(FastList<Key>{0});
+  EXPECT_LONGS_EQUAL(0, isam.covariances().cliquesReused());
+  EXPECT(!isam.covariances().exists(0));
+  EXPECT(assert_equal(isam.marginalCovariance(1),
+                      isam.covariances().marginalCovariance(1), 1e-9));
+}
+
 /* ************************************************************************* */
 TEST(ISAM2, marginalizeLeaves1) {
   ISAM2 isam;
@@ -984,6 +1017,37 @@ TEST(ISAM2, marginalCovariance)
   EXPECT(assert_equal(expected, actual));
 }
 
+/* ************************************************************************* */
+TEST(ISAM2, covariances)
+{
+  Values fullinit;
+  NonlinearFactorGraph fullgraph;
+  ISAM2 isam = createSlamlikeISAM2(&fullinit, &fullgraph);
+
+  const auto& covariances = isam.covariances();
+  EXPECT_LONGS_EQUAL(isam.nodes().size(),
+                     covariances.marginalCovariances().size());
+  for (const auto& [key, value] : isam.getLinearizationPoint())
+    EXPECT(assert_equal(isam.marginalCovariance(key),
+                        covariances.marginalCovariance(key), 1e-7));
+
+  // After an update only the re-eliminated cliques are inverted again
+  Key last = 0;
+  while (isam.valueExists(last + 1)) ++last;
+  NonlinearFactorGraph newFactors;
+  newFactors.emplace_shared<BetweenFactor<Pose2>>(
+      last, last + 1, Pose2(1.0, 0.0, 0.0), odoNoise);
+  Values newValues;
+  newValues.insert(last + 1, Pose2(last + 1.0, 0.0, 0.0));
+  isam.update(newFactors, newValues);
+  const size_t cliques = isam.covariances().cliques();
+  EXPECT(isam.covariances().cliquesReused() > 0);
+  EXPECT(isam.covariances().cliquesReused() < cliques);
+  for (const auto& [key, value] : isam.getLinearizationPoint())
+    EXPECT(assert_equal(isam.marginalCovariance(key),
+                        isam.covariances().marginalCovariance(key), 1e-7));
+}
+
 /* ************************************************************************* */
 TEST(ISAM2, calculate_nnz)
 {
@@ -994,6 +1058,411 @@ TEST(ISAM2, calculate_nnz)
   EXPECT_LONGS_EQUAL(expected, actual);
 }
 
+/* ************************************************************************* */
+TEST(ISAM2, wildfireFixedSizeBlocks)
+{
+  using symbol_shorthand::B;
+  using symbol_shorthand::L;
+  using symbol_shorthand::V;
+  using symbol_shorthand::X;
+
+  // Chains of 6, 3, 9 and 15 dimensional variables with loop closures, so
+  // back-substitution goes through all fixed-size kernels and the dynamic one
+  ISAM2 isam(ISAM2Params(ISAM2GaussNewtonParams(1e-12)));
+  const auto noise = [](size_t dim) {
+    return noiseModel::Isotropic::Sigma(dim, 0.1);
+  };
+  const Pose3 odometry(Rot3::RzRyRx(0.05, -0.02, 0.1), Point3(1, 0.1, 0));
+  for (size_t t = 0; t < 12; ++t) {
+    NonlinearFactorGraph graph;
+    Values init;
+    const double perturbation = 0.01 * t;
+    init.insert(X(t), Pose3(Rot3(), Point3(t + perturbation, 0, 0)));
+    init.insert(L(t), Point3(t, perturbation, 1));
+    init.insert<Vector9>(V(t), Vector9::Constant(t + perturbation));
+    init.insert<Vector15>(B(t), Vector15::Constant(perturbation));
+    if (t == 0) {
+      graph.addPrior(X(0), Pose3(), noise(6));
+      graph.addPrior(L(0), Point3(0, 0, 1), noise(3));
+      graph.addPrior<Vector9>(V(0), Vector9::Zero(), noise(9));
+      graph.addPrior<Vector15>(B(0), Vector15::Zero(), noise(15));
+    } else {
+      graph.emplace_shared<BetweenFactor<Pose3>>(X(t - 1), X(t), odometry,
+                                                 noise(6));
+      graph.emplace_shared<BetweenFactor<Point3>>(L(t - 1), L(t),
+                                                  Point3(1, 0, 0), noise(3));
+      graph.emplace_shared<BetweenFactor<Vector9>>(
+          V(t - 1), V(t), Vector9::Ones(), noise(9));
+      graph.emplace_shared<BetweenFactor<Vector15>>(
+          B(t - 1), B(t), Vector15::Zero(), noise(15));
+    }
+    if (t > 0 && t % 3 == 0) {
+      graph.emplace_shared<BetweenFactor<Pose3>>(
+          X(0), X(t), Pose3(Rot3(), Point3(t, 0, 0)), noise(6));
+      graph.emplace_shared<BetweenFactor<Vector9>>(
+          V(0), V(t), Vector9::Constant(t), noise(9));
+    }
+    isam.update(graph, init);
+
+    // The wildfire solution matches a full back-substitution
+    const Values estimate = isam.calculateEstimate();
+    EXPECT(assert_equal(isam.calculateBestEstimate(), estimate, 1e-6));
+  }
+
+  // Updating with nothing new leaves no clique flagged as replaced
+  isam.update();
+  isam.getDelta();
+  for (const auto& [key, clique] : isam.nodes())
+    EXPECT(!clique->deltaReplaced());
+}
+
+/* ************************************************************************* */
+TEST(ISAM2, maxReeliminationCost)
+{
+  ISAM2 isam = createSlamlikeISAM2();
+  const VectorValues delta = isam.getDelta();
+  const size_t n = isam.getLinearizationPoint().size();
+
+  // With a zero threshold every variable is above it, but none fits a zero
+  // budget, and the deferred cost is that of re-eliminating the whole tree
+  ISAM2UpdateParams updateParams;
+  updateParams.force_relinearize = true;
+  updateParams.maxReeliminationCost = 0.0;
+  ISAM2 none = isam;
+  const ISAM2Result noneResult =
+      none.update(NonlinearFactorGraph(), Values(), updateParams);
+  EXPECT_LONGS_EQUAL(n, noneResult.getVariablesDeferred());
+  EXPECT(assert_equal(isam.getLinearizationPoint(), none.getLinearizationPoint()));
+  const double fullCost = noneResult.getDeferredCost();
+  EXPECT(fullCost > 0.0);
+
+  // Re-eliminating for the variable with the largest delta alone already
+  // costs most of the tree, so with 80% of the full cost only part fit
+  const double partialBudget = 0.8 * fullCost;
+  updateParams.maxReeliminationCost = partialBudget;
+  ISAM2 budgeted = isam;
+  const ISAM2Result result =
+      budgeted.update(NonlinearFactorGraph(), Values(), updateParams);
+  EXPECT(result.getVariablesDeferred() > 0);
+  EXPECT(result.getVariablesDeferred() < n);
+  EXPECT(result.getDeferredCost() > 0.0);
+  EXPECT(result.getDeferredCost() < fullCost);
+
+  // The relinearized variables are those with the largest deltas
+  double smallestRelinearized = std::numeric_limits<double>::infinity();
+  double largestDeferred = 0.0;
+  for (const auto& [key, value] : isam.getLinearizationPoint()) {
+    const double norm = delta[key].lpNorm<Eigen::Infinity>();
+    if (result.deferredRelinKeys.exists(key)) {
+      largestDeferred = std::max(largestDeferred, norm);
+      EXPECT(value.equals_(budgeted.getLinearizationPoint().at(key), 1e-9));
+    } else {
+      smallestRelinearized = std::min(smallestRelinearized, norm);
+      EXPECT(!value.equals_(budgeted.getLinearizationPoint().at(key), 1e-9));
+    }
+  }
+  EXPECT(smallestRelinearized >= largestDeferred);
+
+  // A budget that is not exceeded defers nothing
+  updateParams.maxReeliminationCost = fullCost;
+  ISAM2 unbounded = isam;
+  const ISAM2Result unboundedResult =
+      unbounded.update(NonlinearFactorGraph(), Values(), updateParams);
+  EXPECT_LONGS_EQUAL(0, unboundedResult.getVariablesDeferred());
+  EXPECT_DOUBLES_EQUAL(0.0, unboundedResult.getDeferredCost(), 1e-9);
+
+  // Deferred variables are relinearized by later updates, so both converge to
+  // the same solution, the budgeted one in more updates
+  for (size_t i = 0; i < 10; ++i)
+    unbounded.update(NonlinearFactorGraph(), Values(), updateParams);
+  updateParams.maxReeliminationCost = partialBudget;
+  for (size_t i = 0; i < 40; ++i)
+    budgeted.update(NonlinearFactorGraph(), Values(), updateParams);
+  EXPECT(assert_equal(unbounded.calculateBestEstimate(),
+                      budgeted.calculateBestEstimate(), 1e-3));
+}
+
+/* ************************************************************************* */
+TEST(ISAM2, memoryLimits)
+{
+  // A Pose2 chain with perturbed initial values, grown with one pose per update
+  auto step = [](ISAM2* isam, size_t t) {
+    NonlinearFactorGraph graph;
+    Values init;
+    init.insert(t, Pose2(t + 0.1, 0.05, 0.01 * (t % 3)));
+    if (t == 0)
+      graph.addPrior(0, Pose2(), odoNoise);
+    else
+      graph.emplace_shared<BetweenFactor<Pose2>>(t - 1, t, Pose2(1, 0, 0),
+                                                 odoNoise);
+    return isam->update(graph, init);
+  };
+
+  ISAM2Params params(ISAM2GaussNewtonParams(), 0.01, 1);
+  params.findUnusedFactorSlots = true;
+  params.maxVariables = 10;
+  ISAM2 isam(params);
+  const size_t n = 40;
+  KeyVector marginalized;
+  ISAM2Result result;
+  for (size_t t = 0; t < n; ++t) {
+    result = step(&isam, t);
+    CHECK(result.memory);
+    EXPECT_LONGS_EQUAL(std::min<size_t>(t + 1, 10), result.memory->variables);
+    EXPECT_LONGS_EQUAL(isam.getLinearizationPoint().size(),
+                       result.memory->variables);
+    marginalized.insert(marginalized.end(), result.marginalizedKeys.begin(),
+                        result.marginalizedKeys.end());
+  }
+
+  // The oldest poses were marginalized, in order
+  KeyVector expected(n - 10);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT(expected == marginalized);
+  EXPECT(assert_equal(Pose2(n - 1, 0, 0), isam.calculateEstimate<Pose2>(n - 1),
+                      1e-3));
+
+  // Limits on factors and bytes are met as well
+  ISAM2Params factorParams = params;
+  factorParams.maxVariables = {};
+  factorParams.maxFactors = 5;
+  ISAM2 factorLimited(factorParams);
+  for (size_t t = 0; t < n; ++t)
+    EXPECT(step(&factorLimited, t).memory->factors <= 5);
+  EXPECT_LONGS_EQUAL(5, factorLimited.getFactorsUnsafe().nrFactors());
+
+  ISAM2Params byteParams = params;
+  byteParams.maxVariables = {};
+  byteParams.maxBytes = result.memory->bytes;
+  ISAM2 byteLimited(byteParams);
+  for (size_t t = 0; t < n; ++t) {
+    result = step(&byteLimited, t);
+    EXPECT(result.memory->bytes <= *byteParams.maxBytes);
+    EXPECT_LONGS_EQUAL(result.memory->bytes, byteLimited.memoryUsage().bytes);
+  }
+  EXPECT(byteLimited.getLinearizationPoint().size() < n);
+}
+
+/* ************************************************************************* */
+namespace {
+// Gives access to a full recount of the incrementally tracked memory usage
+class ISAM2WithMemoryRecount : public ISAM2 {
+ public:
+  using ISAM2::ISAM2;
+  ISAM2MemoryUsage recounted() {
+    recountMemoryUsage();
+    return memoryUsage();
+  }
+};
+}  // namespace
+
+TEST(ISAM2, memoryUsageTracked)
+{
+  auto expectTrackedMemoryUsage = [&](ISAM2WithMemoryRecount* isam) {
+    const ISAM2MemoryUsage tracked = isam->memoryUsage();
+    const ISAM2MemoryUsage recounted = isam->recounted();
+    EXPECT_LONGS_EQUAL(recounted.variables, tracked.variables);
+    EXPECT_LONGS_EQUAL(recounted.factors, tracked.factors);
+    EXPECT_LONGS_EQUAL(recounted.bytes, tracked.bytes);
+  };
+  for (bool cacheLinearizedFactors : {true, false}) {
+    ISAM2Params params(ISAM2GaussNewtonParams(), 0.01, 1);
+    params.cacheLinearizedFactors = cacheLinearizedFactors;
+    params.maxVariables = 15;
+    ISAM2WithMemoryRecount isam(params);
+
+    // A Pose2 chain with loop closures, removing a factor now and then
+    for (size_t t = 0; t < 30; ++t) {
+      NonlinearFactorGraph graph;
+      Values init;
+      init.insert(t, Pose2(t + 0.1, 0.05, 0.01 * (t % 3)));
+      if (t == 0)
+        graph.addPrior(0, Pose2(), odoNoise);
+      else
+        graph.emplace_shared<BetweenFactor<Pose2>>(t - 1, t, Pose2(1, 0, 0),
+                                                   odoNoise);
+      if (t >= 4 && t % 4 == 0)
+        graph.emplace_shared<BetweenFactor<Pose2>>(t - 3, t, Pose2(3, 0, 0),
+                                                   odoNoise);
+      ISAM2UpdateParams updateParams;
+      if (t % 7 == 6) {
+        // Remove the previous loop closure
+        const auto& factors = isam.getFactorsUnsafe();
+        for (size_t i = factors.size(); i-- > 0;)
+          if (factors[i] && factors[i]->size() == 2 &&
+              factors[i]->front() + 3 == factors[i]->back()) {
+            updateParams.removeFactorIndices.push_back(i);
+            break;
+          }
+      }
+      isam.update(graph, init, updateParams);
+      expectTrackedMemoryUsage(&isam);
+    }
+
+    // Marginalize the first frontal variable of a leaf clique, which may trim
+    // the clique in place
+    for (const auto& [key, clique] : isam.nodes()) {
+      if (clique->children.empty()) {
+        isam.marginalizeLeaves({clique->conditional()->front()});
+        break;
+      }
+    }
+    expectTrackedMemoryUsage(&isam);
+  }
+}
+
+/* ************************************************************************* */
+TEST(ISAM2, memoryLimitsRootLeaves)
+{
+  // Independent variables with priors, each in its own root clique
+  ISAM2Params params;
+  params.maxVariables = 3;
+  ISAM2 isam(params);
+  ISAM2Result result;
+  for (size_t t = 0; t < 6; ++t) {
+    NonlinearFactorGraph graph;
+    Values init;
+    graph.addPrior(t, Pose2(t, 0, 0), odoNoise);
+    init.insert(t, Pose2(t, 0, 0));
+    result = isam.update(graph, init);
+    EXPECT(result.withinMemoryLimits);
+  }
+  EXPECT_LONGS_EQUAL(3, result.memory->variables);
+  EXPECT(isam.getLinearizationPoint().exists(5));
+  EXPECT(!isam.getLinearizationPoint().exists(2));
+
+  // Variables touched by the update are kept even if over the limits
+  NonlinearFactorGraph graph;
+  Values init;
+  for (size_t t = 6; t < 10; ++t) {
+    graph.addPrior(t, Pose2(t, 0, 0), odoNoise);
+    init.insert(t, Pose2(t, 0, 0));
+  }
+  result = isam.update(graph, init);
+  EXPECT(!result.withinMemoryLimits);
+  EXPECT_LONGS_EQUAL(4, result.memory->variables);
+}
+
+/* ************************************************************************* */
+TEST(ISAM2, compactFactors)
+{
+  // A Pose2 chain where every odometry factor is duplicated
+  const size_t n = 10;
+  NonlinearFactorGraph graph;
+  Values init;
+  graph.addPrior(0, Pose2(), odoNoise);
+  init.insert(0, Pose2(0.1, 0, 0));
+  for (size_t t = 1; t < n; ++t) {
+    for (size_t copy = 0; copy < 2; ++copy)
+      graph.emplace_shared<BetweenFactor<Pose2>>(t - 1, t, Pose2(1, 0, 0),
+                                                 odoNoise);
+    init.insert(t, Pose2(t + 0.1, 0.05, 0.01));
+  }
+  ISAM2Params params(ISAM2GaussNewtonParams(), 0.01, 1);
+  ISAM2 isam(params);
+  const FactorIndices indices = isam.update(graph, init).newFactorsIndices;
+
+  // Removing the duplicates leaves every other slot empty
+  FactorIndices duplicates;
+  for (size_t i = 2; i < indices.size(); i += 2) duplicates.push_back(indices[i]);
+  isam.update(NonlinearFactorGraph(), Values(), duplicates);
+  ISAM2 compacted = isam;
+  const FactorIndices newIndices = compacted.compactFactors();
+  LONGS_EQUAL(indices.size(), newIndices.size());
+  EXPECT_LONGS_EQUAL(n, compacted.getFactorsUnsafe().size());
+  EXPECT_LONGS_EQUAL(n, compacted.getFactorsUnsafe().nrFactors());
+  EXPECT(assert_equal(VariableIndex(compacted.getFactorsUnsafe()),
+                      compacted.getVariableIndex()));
+  for (size_t i = 0; i < indices.size(); ++i) {
+    if (isam.getFactorsUnsafe()[indices[i]]) {
+      EXPECT(isam.getFactorsUnsafe()[indices[i]] ==
+             compacted.getFactorsUnsafe()[newIndices[indices[i]]]);
+    } else {
+      EXPECT(newIndices[indices[i]] == ISAM2::kEmptyFactorSlot);
+    }
+  }
+
+  // The compacted system gives the same results, for later updates too
+  EXPECT(assert_equal(isam.calculateEstimate(), compacted.calculateEstimate(),
+                      1e-9));
+  NonlinearFactorGraph loop;
+  loop.emplace_shared<BetweenFactor<Pose2>>(0, n - 1, Pose2(n - 1, 0, 0),
+                                            odoNoise);
+  isam.update(loop, Values(), FactorIndices{indices[1]});
+  compacted.update(loop, Values(), FactorIndices{newIndices[indices[1]]});
+  EXPECT(assert_equal(isam.calculateEstimate(), compacted.calculateEstimate(),
+                      1e-9));
+
+  // Automatic compaction renumbers the indices of the new factors as well
+  params.compactionThreshold = 0.25;
+  ISAM2 automatic(params);
+  automatic.update(graph, init);
+  const ISAM2Result result =
+      automatic.update(loop, Values(), ISAM2UpdateParams{});
+  EXPECT(result.factorIndexMap.empty());
+  ISAM2UpdateParams updateParams;
+  updateParams.removeFactorIndices = duplicates;
+  const ISAM2Result compactedResult =
+      automatic.update(loop, Values(), updateParams);
+  LONGS_EQUAL(indices.size() + 2, compactedResult.factorIndexMap.size());
+  EXPECT_LONGS_EQUAL(n + 2, automatic.getFactorsUnsafe().size());
+  EXPECT(automatic.getFactorsUnsafe()[compactedResult.newFactorsIndices[0]] ==
+         loop[0]);
+}
+
+/* ************************************************************************* */
+namespace {
+// Gives access to the cached linear factors
+class ISAM2WithLinearFactors : public ISAM2 {
+ public:
+  using ISAM2::ISAM2;
+  const GaussianFactorGraph& linearFactors() const { return linearFactors_; }
+};
+}  // namespace
+
+TEST(ISAM2, relinearizeInPlace)
+{
+  // A Pose2 chain with loop closures and perturbed initial values
+  NonlinearFactorGraph graph;
+  Values init;
+  graph.addPrior(0, Pose2(), odoNoise);
+  init.insert(0, Pose2(0.1, -0.1, 0.02));
+  for (size_t t = 1; t < 20; ++t) {
+    graph.emplace_shared<BetweenFactor<Pose2>>(t - 1, t, Pose2(1, 0, 0.1),
+                                               odoNoise);
+    if (t % 5 == 0)
+      graph.emplace_shared<BetweenFactor<Pose2>>(t - 5, t, Pose2(5, 0, 0.5),
+                                                 odoNoise);
+    init.insert(t, Pose2(t + 0.1, 0.2 * (t % 3), 0.1 * t - 0.03));
+  }
+  ISAM2Params params(ISAM2GaussNewtonParams(), 0.0, 1);
+  ISAM2WithLinearFactors isam(params);
+  isam.update(graph, init);
+  params.cacheLinearizedFactors = false;
+  ISAM2 uncached(params);
+  uncached.update(graph, init);
+
+  std::vector<const GaussianFactor*> before;
+  for (const auto& factor : isam.linearFactors()) before.push_back(factor.get());
+
+  ISAM2UpdateParams updateParams;
+  updateParams.force_relinearize = true;
+  for (size_t i = 0; i < 3; ++i) {
+    isam.update(NonlinearFactorGraph(), Values(), updateParams);
+    uncached.update(NonlinearFactorGraph(), Values(), updateParams);
+  }
+
+  // The cached factors were overwritten in place with the new linearization
+  const Values& theta = isam.getLinearizationPoint();
+  for (size_t i = 0; i < graph.size(); ++i) {
+    EXPECT(before[i] == isam.linearFactors()[i].get());
+    EXPECT(assert_equal(*graph[i]->linearize(theta), *isam.linearFactors()[i],
+                        1e-9));
+  }
+  EXPECT(assert_equal(uncached.calculateEstimate(), isam.calculateEstimate(),
+                      1e-9));
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
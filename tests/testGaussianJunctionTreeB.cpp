@@ -109,6 +109,25 @@ TEST( GaussianJunctionTreeB, constructor2 ) {
   EXPECT_LONGS_EQUAL(4, x1->problemSize_);
 }
 
+/* ************************************************************************* */
+TEST(GaussianJunctionTreeB, cost) {
+  // Chain x0 - x1 - x2 with dimensions 2, 3 and 1
+  GaussianFactorGraph fg;
+  fg.emplace_shared<JacobianFactor>(X(0), Matrix::Identity(2, 2), X(1),
+                                    Matrix::Ones(2, 3), Vector2::Zero());
+  fg.emplace_shared<JacobianFactor>(X(1), Matrix::Identity(3, 3), X(2),
+                                    Matrix::Ones(3, 1), Vector3::Zero());
+
+  // Root {x1, x0} has no separator, child {x2} has separator {x1}
+  const Ordering ordering{X(0), X(2), X(1)};
+  GaussianJunctionTree actual(GaussianEliminationTree(fg, ordering));
+  const auto& root = actual.roots().front();
+  const auto& child = root->children.front();
+  EXPECT_DOUBLES_EQUAL(125.0 / 3.0, root->cost(), 1e-9);
+  EXPECT_DOUBLES_EQUAL(1.0 / 3.0 + 3.0 + 9.0, child->cost(), 1e-9);
+  EXPECT_DOUBLES_EQUAL(root->cost() + child->cost(), root->subtreeCost(), 1e-9);
+}
+
 ///* ************************************************************************* */
 TEST(GaussianJunctionTreeB, OptimizeMultiFrontal) {
   // create a graph
@@ -258,6 +258,88 @@ TEST(Marginals, order) {
   testMarginals(marginals, set);
 }
 
+/* ************************************************************************* */
+TEST(Marginals, covariances) {
+  // A chain of poses, each observing a landmark
+  NonlinearFactorGraph fg;
+  Values vals;
+  fg.addPrior(0, Pose2(), noiseModel::Unit::Create(3));
+  for (size_t i = 0; i < 10; ++i) {
+    vals.insert(i, Pose2(i, 0, 0));
+    vals.insert(100 + i, Point2(i, 1));
+    if (i > 0)
+      fg.emplace_shared<BetweenFactor<Pose2>>(i - 1, i, Pose2(1, 0, 0),
+                                              noiseModel::Unit::Create(3));
+    fg.emplace_shared<BearingRangeFactor<Pose2, Point2>>(
+        i, 100 + i, Rot2::fromDegrees(90), 1.0, noiseModel::Unit::Create(2));
+  }
+
+  Marginals marginals(fg, vals);
+  const auto& covariances = marginals.covariances();
+  EXPECT_LONGS_EQUAL(20, covariances.marginalCovariances().size());
+  for (Key j : fg.keys())
+    EXPECT(assert_equal(marginals.marginalCovariance(j),
+                        covariances.marginalCovariance(j), 1e-9));
+
+  // Off-diagonal blocks of variables that share a clique
+  size_t found = 0;
+  for (Key i : fg.keys()) {
+    for (Key j : fg.keys()) {
+      if (i == j) continue;
+      try {
+        const Matrix actual = covariances.covariance(i, j);
+        EXPECT(assert_equal(marginals.jointMarginalCovariance({i, j})(i, j),
+                            actual, 1e-9));
+        ++found;
+      } catch (const std::invalid_argument&) {
+      }
+    }
+  }
+  EXPECT(found > 0);
+}
+
+namespace {
+// A chain of ten poses, each observing a landmark
+void createChain(NonlinearFactorGraph* fg, Values* vals) {
+  fg->addPrior(0, Pose2(), noiseModel::Unit::Create(3));
+  for (size_t i = 0; i < 10; ++i) {
+    vals->insert(i, Pose2(i, 0, 0));
+    vals->insert(100 + i, Point2(i, 1));
+    if (i > 0)
+      fg->emplace_shared<BetweenFactor<Pose2>>(i - 1, i, Pose2(1, 0, 0),
+                                               noiseModel::Unit::Create(3));
+    fg->emplace_shared<BearingRangeFactor<Pose2, Point2>>(
+        i, 100 + i, Rot2::fromDegrees(90), 1.0, noiseModel::Unit::Create(2));
+  }
+}
+}  // namespace
+
+/* ************************************************************************* */
+TEST(Marginals, jointMarginalCovariances) {
+  NonlinearFactorGraph fg;
+  Values vals;
+  createChain(&fg, &vals);
+  const Marginals marginals(fg, vals);
+
+  // Pairs within a clique, pairs far apart, a single variable and a triple
+  std::vector<KeyVector> queries;
+  for (Key i = 0; i < 10; ++i) queries.push_back({100 + i, i});
+  for (Key i = 0; i < 10; ++i) queries.push_back({i, 109 - i});
+  queries.push_back({5});
+  queries.push_back({9, 0, 104});
+
+  const std::vector<JointMarginal> actual =
+      marginals.jointMarginalCovariances(queries);
+  LONGS_EQUAL(queries.size(), actual.size());
+  for (size_t q = 0; q < queries.size(); ++q) {
+    const JointMarginal expected = marginals.jointMarginalCovariance(queries[q]);
+    EXPECT(assert_equal(expected.fullMatrix(), actual[q].fullMatrix(), 1e-9));
+    EXPECT(assert_equal(expected(queries[q].front(), queries[q].back()),
+                        actual[q](queries[q].front(), queries[q].back()),
+                        1e-9));
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
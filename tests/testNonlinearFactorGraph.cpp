@@ -131,6 +131,36 @@ TEST( NonlinearFactorGraph, linearize )
   CHECK(assert_equal(expected,linearFG)); // Needs correct linearizations
 }
 
+/* ************************************************************************* */
+TEST( NonlinearFactorGraph, linearizeInto )
+{
+  NonlinearFactorGraph fg = createNonlinearFactorGraph();
+  Values initial = createNoisyValues();
+  Values values = createValues();
+
+  // First call allocates all linear factors
+  GaussianFactorGraph linearFG;
+  fg.linearizeInto(initial, linearFG);
+  EXPECT(assert_equal(*fg.linearize(initial), linearFG));
+
+  // Keep the factor pointers around, but not the factors themselves
+  std::vector<const GaussianFactor*> previous;
+  for (const auto& factor : linearFG) previous.push_back(factor.get());
+
+  // Second call overwrites the factors in place
+  fg.linearizeInto(values, linearFG);
+  EXPECT(assert_equal(*fg.linearize(values), linearFG));
+  for (size_t i = 0; i < linearFG.size(); ++i)
+    EXPECT(previous[i] == linearFG[i].get());
+
+  // A linear factor that is shared elsewhere is replaced, not modified
+  GaussianFactor::shared_ptr shared = linearFG[0];
+  fg.linearizeInto(initial, linearFG);
+  EXPECT(shared != linearFG[0]);
+  EXPECT(assert_equal(*fg.linearize(values)->at(0), *shared));
+  EXPECT(assert_equal(*fg.linearize(initial), linearFG));
+}
+
 /* ************************************************************************* */
 TEST( NonlinearFactorGraph, clone )
 {
@@ -215,6 +245,28 @@ TEST(NonlinearFactorGraph, UpdateCholesky) {
   EXPECT(assert_equal(initial, fg.updateCholesky(initial, dampen), 1e-6));
 }
 
+/* ************************************************************************* */
+TEST(NonlinearFactorGraph, linearizeToHessianFactorMany) {
+  // Many more factors than variables, as in calibration problems
+  NonlinearFactorGraph fg;
+  Values values;
+  const auto model = noiseModel::Isotropic::Sigma(3, 0.1);
+  const size_t n = 10;
+  for (size_t j = 0; j < n; ++j) values.insert(X(j), Pose2(j, 0.1 * j, 0.01 * j));
+  fg.addPrior(X(0), Pose2(), model);
+  for (size_t k = 0; k < 5000; ++k) {
+    const size_t i = k % n, j = (7 * k + 1) % n;
+    if (i != j)
+      fg.emplace_shared<BetweenFactor<Pose2>>(
+          X(i), X(j), Pose2(j - i, 0.1, 0.001 * k), model);
+  }
+
+  const Ordering ordering = Ordering::Natural(fg);
+  const Matrix expected = fg.linearize(values)->augmentedHessian(ordering);
+  const auto actual = fg.linearizeToHessianFactor(values, ordering);
+  EXPECT(assert_equal(expected, actual->augmentedInformation(), 1e-6));
+}
+
 /* ************************************************************************* */
 // Example from issue #452 which threw an ILS error. The reason was a very 
 // weak prior on heading, which was tightened, and the ILS disappeared.
@@ -179,6 +179,71 @@ TEST( NonlinearOptimizer, optimization_method )
 
   Values actualMFChol = LevenbergMarquardtOptimizer(fg, c0, paramsChol).optimize();
   DOUBLES_EQUAL(0,fg.error(actualMFChol),tol);
+
+  LevenbergMarquardtParams paramsSparse;
+  paramsSparse.linearSolverType = LevenbergMarquardtParams::CHOLMOD;
+  Values actualSparse = LevenbergMarquardtOptimizer(fg, c0, paramsSparse).optimize();
+  DOUBLES_EQUAL(0,fg.error(actualSparse),tol);
+}
+
+/* ************************************************************************* */
+TEST( NonlinearOptimizer, SparseCholesky )
+{
+  // Pose2 loop, where every iteration reuses the sparse symbolic factorization
+  NonlinearFactorGraph graph;
+  Values initial;
+  const auto model = noiseModel::Isotropic::Sigma(3, 0.1);
+  graph.addPrior(X(0), Pose2(), model);
+  for (size_t j = 0; j < 8; ++j) {
+    graph.emplace_shared<BetweenFactor<Pose2>>(X(j), X((j + 1) % 8),
+                                               Pose2(1, 0, M_PI_4), model);
+    initial.insert(X(j), Pose2(0.1 * j, 0.2 * j, 0.7 * j));
+  }
+
+  LevenbergMarquardtParams paramsChol;
+  const Values expected =
+      LevenbergMarquardtOptimizer(graph, initial, paramsChol).optimize();
+
+  LevenbergMarquardtParams paramsSparse;
+  paramsSparse.linearSolverType = LevenbergMarquardtParams::CHOLMOD;
+  EXPECT(assert_equal(expected,
+      LevenbergMarquardtOptimizer(graph, initial, paramsSparse).optimize(), 1e-6));
+
+  GaussNewtonParams paramsGN;
+  paramsGN.linearSolverType = GaussNewtonParams::CHOLMOD;
+  EXPECT(assert_equal(expected,
+      GaussNewtonOptimizer(graph, initial, paramsGN).optimize(), 1e-6));
+}
+
+/* ************************************************************************* */
+TEST( NonlinearOptimizer, ReuseFrontalMatrices )
+{
+  // Pose2 loop with a spur, solved with frontal matrices kept across iterations
+  NonlinearFactorGraph graph;
+  Values initial;
+  const auto model = noiseModel::Isotropic::Sigma(3, 0.1);
+  graph.addPrior(X(0), Pose2(), model);
+  for (size_t j = 0; j < 8; ++j) {
+    graph.emplace_shared<BetweenFactor<Pose2>>(X(j), X((j + 1) % 8),
+                                               Pose2(1, 0, M_PI_4), model);
+    graph.emplace_shared<BetweenFactor<Pose2>>(X(j), X(10 + j),
+                                               Pose2(0, 1, 0), model);
+    initial.insert(X(j), Pose2(0.1 * j, 0.2 * j, 0.7 * j));
+    initial.insert(X(10 + j), Pose2(0.1 * j, 1.2 * j, 0.7 * j));
+  }
+
+  LevenbergMarquardtParams params;
+  const Values expected =
+      LevenbergMarquardtOptimizer(graph, initial, params).optimize();
+
+  params.reuseFrontalMatrices = true;
+  EXPECT(assert_equal(expected,
+      LevenbergMarquardtOptimizer(graph, initial, params).optimize(), 1e-6));
+
+  GaussNewtonParams paramsGN;
+  paramsGN.reuseFrontalMatrices = true;
+  EXPECT(assert_equal(expected,
+      GaussNewtonOptimizer(graph, initial, paramsGN).optimize(), 1e-6));
 }
 
 /* ************************************************************************* */
@@ -0,0 +1,132 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file testStaticExpression.cpp
+ * @brief Unit tests for StaticExpression and its use in ExpressionFactor
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/StaticExpression.h>
+#include <gtsam/nonlinear/expressionTesting.h>
+#include <gtsam/slam/expressions.h>
+
+using namespace std;
+using namespace gtsam;
+using symbol_shorthand::K;
+using symbol_shorthand::L;
+using symbol_shorthand::X;
+
+namespace {
+const SharedNoiseModel model = noiseModel::Isotropic::Sigma(2, 0.5);
+const Point2 measured(310, 230);
+
+Values values() {
+  Values values;
+  values.insert(K(0), Cal3_S2(500, 510, 0.1, 320, 240));
+  values.insert(X(0), Pose3(Rot3::Ypr(0.1, -0.2, 0.3), Point3(0.2, 0.1, -5)));
+  values.insert(L(0), Point3(0.3, -0.2, 0.4));
+  return values;
+}
+}  // namespace
+
+/* ************************************************************************* */
+TEST(StaticExpression, value) {
+  const StaticLeaf<Pose3> x(X(0));
+  const StaticLeaf<Point3> p(L(0));
+  const auto projected = project(transformTo(x, p));
+  const Point2 expected = project(transformTo(Pose3_(X(0)), Point3_(L(0))))
+                              .value(values());
+  EXPECT(assert_equal(expected, projected.value(values())));
+
+  // The equivalent dynamic expression
+  const Expression<Point2> dynamic = projected.expression();
+  EXPECT(assert_equal(expected, dynamic.value(values())));
+  EXPECT(dynamic.keys() == std::set<Key>({X(0), L(0)}));
+}
+
+/* ************************************************************************* */
+TEST(StaticExpression, factor) {
+  const StaticLeaf<Cal3_S2> k(K(0));
+  const StaticLeaf<Pose3> x(X(0));
+  const StaticLeaf<Point3> p(L(0));
+  const ExpressionFactor<Point2> factor(
+      model, measured, uncalibrate(k, project(transformTo(x, p))));
+  const ExpressionFactor<Point2> expected(
+      model, measured,
+      uncalibrate(Cal3_S2_(K(0)),
+                  project(transformTo(Pose3_(X(0)), Point3_(L(0))))));
+
+  EXPECT(factor.keys() == expected.keys());
+  EXPECT_DOUBLES_EQUAL(expected.error(values()), factor.error(values()), 1e-9);
+  EXPECT(assert_equal(*expected.linearize(values()),
+                      *factor.linearize(values()), 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values(), 1e-5, 1e-5);
+}
+
+/* ************************************************************************* */
+TEST(StaticExpression, constant) {
+  // Only the pose and point are unknown, the calibration is constant
+  const StaticConstant<Cal3_S2> k(Cal3_S2(500, 510, 0.1, 320, 240));
+  const StaticLeaf<Pose3> x(X(0));
+  const StaticLeaf<Point3> p(L(0));
+  const ExpressionFactor<Point2> factor(
+      model, measured, uncalibrate(k, project(transformFrom(x, p))));
+  EXPECT_LONGS_EQUAL(2, factor.size());
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values(), 1e-5, 1e-5);
+}
+
+/* ************************************************************************* */
+// An ExpressionFactorN switched over to a StaticExpression
+namespace {
+auto projection(Key k, Key x, Key p) {
+  return uncalibrate(StaticLeaf<Cal3_S2>(k),
+                     project(transformTo(StaticLeaf<Pose3>(x),
+                                         StaticLeaf<Point3>(p))));
+}
+}  // namespace
+
+class StaticProjectionFactor
+    : public ExpressionFactorN<Point2, Cal3_S2, Pose3, Point3> {
+ public:
+  StaticProjectionFactor(Key k, Key x, Key p, const Point2& z)
+      : ExpressionFactorN<Point2, Cal3_S2, Pose3, Point3>({k, x, p}, model, z) {
+    initialize(projection(k, x, p));
+  }
+
+  Expression<Point2> expression(const ArrayNKeys& keys) const override {
+    return projection(keys[0], keys[1], keys[2]).expression();
+  }
+};
+
+TEST(StaticExpression, ExpressionFactorN) {
+  const StaticProjectionFactor factor(K(0), X(0), L(0), measured);
+  EXPECT(factor.keys() == KeyVector({K(0), X(0), L(0)}));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values(), 1e-5, 1e-5);
+
+  // Relinearizing in place uses the fused kernel as well
+  GaussianFactor::shared_ptr result;
+  factor.linearizeInto(values(), result);
+  Values moved = values();
+  moved.update(L(0), Point3(0.1, 0.2, 0.3));
+  factor.linearizeInto(moved, result);
+  EXPECT(assert_equal(*factor.linearize(moved), *result, 1e-9));
+}
+
+/* ************************************************************************* */
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
+/* ************************************************************************* */
@@ -19,6 +19,7 @@
 #include <gtsam/slam/expressions.h>
 #include <gtsam/nonlinear/ExpressionFactor.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/slam/GeneralSFMFactor.h>
 #include <gtsam/linear/GaussianFactorGraph.h>
 
 #include <time.h>
@@ -78,5 +79,40 @@ int main() {
   cout << seconds << " seconds to linearize" << endl;
   cout << ((double) seconds * 1000000 / n) << " musecs/call" << endl;
 
+  // Same factors with StaticExpressions, evaluated by fused kernels
+  StaticLeaf<Cal3_S2> staticK(Symbol('K', 0));
+  NonlinearFactorGraph staticGraph;
+  for (size_t i = 0; i < M; i++) {
+    StaticLeaf<Pose3> xi(Symbol('x', i));
+    for (size_t j = 0; j < N; j++) {
+      StaticLeaf<Point3> pj(Symbol('p', j));
+      staticGraph.emplace_shared<ExpressionFactor<Point2> >(
+          model, z, uncalibrate(staticK, project(transformTo(xi, pj))));
+    }
+  }
+
+  gfg.reset();  // don't time freeing the previous linear graph
+  timeLog = clock();
+  gfg = staticGraph.linearize(values);
+  timeLog2 = clock();
+  seconds = (double) (timeLog2 - timeLog) / CLOCKS_PER_SEC;
+  cout << seconds << " seconds to linearize static expressions" << endl;
+  cout << ((double) seconds * 1000000 / n) << " musecs/call" << endl;
+
+  // Same factors, hand-coded
+  NonlinearFactorGraph sfmGraph;
+  for (size_t i = 0; i < M; i++)
+    for (size_t j = 0; j < N; j++)
+      sfmGraph.emplace_shared<GeneralSFMFactor2<Cal3_S2> >(
+          z, model, Symbol('x', i), Symbol('p', j), Symbol('K', 0));
+
+  gfg.reset();  // don't time freeing the previous linear graph
+  timeLog = clock();
+  gfg = sfmGraph.linearize(values);
+  timeLog2 = clock();
+  seconds = (double) (timeLog2 - timeLog) / CLOCKS_PER_SEC;
+  cout << seconds << " seconds to linearize GeneralSFMFactor2" << endl;
+  cout << ((double) seconds * 1000000 / n) << " musecs/call" << endl;
+
   return 0;
 }